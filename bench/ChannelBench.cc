@@ -0,0 +1,80 @@
+#include "cxx/Channel.h"
+#include "cxx/Ref.h"
+#include "cxx/test/Bench.h"
+
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+using cxx::test::Bench;
+using cxx::test::keep;
+int main(int, char**) { return cxx::test::runBenches(); }
+
+constexpr size_t kCapacity = 1024;
+
+// Send `n` values in total from `producers` threads, received by `consumers` threads.
+void run(uint64_t n, int producers, int consumers) {
+    cxx::Channel<uint64_t> ch(kCapacity);
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; c++) {
+        threads.emplace_back([&ch] {
+            uint64_t sum = 0;
+            while (auto val = ch.recv()) { sum += *val; }
+            keep(sum);
+        });
+    }
+    std::vector<std::thread> senders;
+    for (int p = 0; p < producers; p++) {
+        senders.emplace_back([&ch, n, producers, p] {
+            for (uint64_t i = p; i < n; i += producers) { ch.send(i); }
+        });
+    }
+    for (auto& t : senders) { t.join(); }
+    ch.close();
+    for (auto& t : threads) { t.join(); }
+}
+
+Bench channel1P1C("Channel<uint64_t> 1 producer, 1 consumer", [](uint64_t n) { run(n, 1, 1); });
+Bench channel1P4C("Channel<uint64_t> 1 producer, 4 consumers", [](uint64_t n) { run(n, 1, 4); });
+Bench channel4P4C("Channel<uint64_t> 4 producers, 4 consumers", [](uint64_t n) { run(n, 4, 4); });
+
+Bench channelRefs1P1C("Channel<Ref<int>> 1 producer, 1 consumer", [](uint64_t n) {
+    cxx::Channel<cxx::Ref<int>> ch(kCapacity);
+    std::thread consumer([&ch] {
+        while (auto ref = ch.recv()) { keep(**ref); }
+    });
+    for (uint64_t i = 0; i < n; i++) { ch.send(cxx::Ref<int>::make(int(i))); }
+    ch.close();
+    consumer.join();
+});
+
+// For comparison, the ad-hoc approach: a `std::queue` behind a `std::mutex`, polled by the consumer.
+Bench mutexQueue1P1C("std::mutex + std::queue 1 producer, 1 consumer", [](uint64_t n) {
+    std::mutex mutex;
+    std::queue<uint64_t> queue;
+    bool done = false;
+    std::thread consumer([&] {
+        uint64_t sum = 0;
+        while (true) {
+            std::lock_guard lock(mutex);
+            if (!queue.empty()) {
+                sum += queue.front();
+                queue.pop();
+            } else if (done) {
+                break;
+            }
+        }
+        keep(sum);
+    });
+    for (uint64_t i = 0; i < n; i++) {
+        std::lock_guard lock(mutex);
+        queue.push(i);
+    }
+    {
+        std::lock_guard lock(mutex);
+        done = true;
+    }
+    consumer.join();
+});
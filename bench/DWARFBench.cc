@@ -0,0 +1,78 @@
+#include "cxx/StackTrace.h"
+#include "cxx/test/Bench.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <filesystem>
+#include <string>
+
+using cxx::test::Bench;
+using cxx::test::keep;
+int main(int, char**) { return cxx::test::runBenches(); }
+
+/** Binary to decode: `$DWARF_BENCH_BINARY` (ideally something large), else this program. */
+cxx::Ref<cxx::Binary> benchBinary() {
+    static auto ret = [] {
+        if (auto* env = getenv("DWARF_BENCH_BINARY")) { return cxx::Binary::open(env, 0); }
+        Dl_info info;
+        dladdr((void*) &benchBinary, &info);
+        auto bin = cxx::Binary::open(info.dli_fname, 0);
+        bin->rebase(uintptr_t(info.dli_fbase));
+        return bin;
+    }();
+    return ret;
+}
+
+void decodeAll(uint64_t n, unsigned workers) {
+    auto bin = benchBinary();
+    for (uint64_t i = 0; i < n; i++) {
+        cxx::LineIndex index(bin.get());
+        index.decodeAll(workers);
+        keep(index.decodedCount());
+    }
+}
+
+Bench decodeSerial("DWARF: decode all line units, 1 thread", [](uint64_t n) {
+    decodeAll(n, 1);
+});
+
+Bench decodeParallel("DWARF: decode all line units, all cores", [](uint64_t n) {
+    decodeAll(n, 0);
+});
+
+// Only decodes the one unit covering the address (if this program is the one being decoded)
+Bench lookupOne("DWARF: open index and look up one address", [](uint64_t n) {
+    auto bin = benchBinary();
+    auto addr = uintptr_t(&benchBinary) - bin->vmaSlide_;
+    for (uint64_t i = 0; i < n; i++) {
+        cxx::LineIndex index(bin.get());
+        keep(index.find(addr));
+    }
+});
+
+// The same lookup with the work done ahead of time: in a `SymbolIndex`, which is just mapped
+Bench lookupIndexed("DWARF: map symbol index and look up one address", [](uint64_t n) {
+    auto bin = benchBinary();
+    auto addr = uintptr_t(&benchBinary) - bin->vmaSlide_;
+    auto id = bin->buildID().empty() ? std::string("bench") : bin->buildID();
+    static auto const path = [&] {
+        auto ret = (std::filesystem::temp_directory_path() / "cxx-bench.symidx").string();
+        cxx::SymbolIndex::write(ret, id, {bin.get()});
+        return ret;
+    }();
+    for (uint64_t i = 0; i < n; i++) {
+        auto index = cxx::SymbolIndex::load(path, id);
+        keep(index->line(addr));
+    }
+});
+
+// Inflates it, if compressed (e.g. built with `-gz`): each iteration opens the binary afresh
+Bench readInfo("DWARF: open binary and read .debug_info", [](uint64_t n) {
+    auto path = benchBinary()->file_->path_;
+    for (uint64_t i = 0; i < n; i++) {
+        auto bin = cxx::Binary::open(path, 0);
+        cxx::DWARF dwarf(*bin);
+        if (dwarf.info_) { keep(dwarf.info_->contents().peekU8(0)); }
+    }
+});
@@ -0,0 +1,86 @@
+#include "cxx/Exception.h"
+#include "cxx/StackTrace.h"
+#include "cxx/test/Bench.h"
+
+#include <cstdint>
+#include <stdexcept>
+
+using cxx::test::Bench;
+using cxx::test::keep;
+int main(int, char**) { return cxx::test::runBenches(); }
+
+struct BenchException : cxx::Exception<BenchException> {
+    using Exception::Exception;
+};
+
+cxx::CaptureControl untraced {cxx::CapturePolicy::never()};
+
+// Keep the throwing functions out of line, so there's some stack to walk
+[[gnu::noinline]] void throwCxx() { throw BenchException(); }
+[[gnu::noinline]] void throwCxxUntraced() { throw BenchException(untraced); }
+[[gnu::noinline]] void throwStd() { throw std::runtime_error("bench"); }
+[[gnu::noinline]] void throwCxxMsg(int i) { throw BenchException() << "bad value: " << i; }
+[[gnu::noinline]] void throwCxxFmt(int i) { throw BenchException().format("bad value: {}", i); }
+
+Bench capture("StackTrace: capture only", [](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        cxx::StackTrace trace;
+        keep(trace.size());
+    }
+});
+
+Bench captureAndFrames("StackTrace: capture, then build frames", [](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        cxx::StackTrace trace;
+        keep(trace.frames().get());
+    }
+});
+
+Bench captureAndResolve("StackTrace: capture and resolve, warm cache", [](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        cxx::StackTrace trace;
+        cxx::StackResolver sr;
+        trace.resolve(sr);
+        keep(trace.frames().get());
+    }
+});
+
+Bench throwCatchCxx("cxx::Exception: throw and catch", [](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        try {
+            throwCxx();
+        } catch (BenchException const& e) { keep(e); }
+    }
+});
+
+Bench throwCatchCxxUntraced("cxx::Exception: throw and catch, no trace", [](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        try {
+            throwCxxUntraced();
+        } catch (BenchException const& e) { keep(e); }
+    }
+});
+
+Bench throwCatchCxxMsg("cxx::Exception: operator<< message, what()", [](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        try {
+            throwCxxMsg(int(i));
+        } catch (BenchException const& e) { keep(e.what()); }
+    }
+});
+
+Bench throwCatchCxxFmt("cxx::Exception: format() message, what()", [](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        try {
+            throwCxxFmt(int(i));
+        } catch (BenchException const& e) { keep(e.what()); }
+    }
+});
+
+Bench throwCatchStd("std::runtime_error: throw and catch", [](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        try {
+            throwStd();
+        } catch (std::runtime_error const& e) { keep(e); }
+    }
+});
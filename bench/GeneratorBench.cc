@@ -0,0 +1,153 @@
+#include "cxx/Generator.h"
+#include "cxx/test/Bench.h"
+
+#include <cstdint>
+#include <functional>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using cxx::test::Bench;
+using cxx::test::keep;
+int main(int, char**) { return cxx::test::runBenches(); }
+
+cxx::Generator<uint64_t> nothing() { co_return; }
+
+cxx::Generator<uint64_t> count(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) { co_yield uint64_t(i); }
+}
+
+cxx::Generator<std::string> strings(uint64_t n) {
+    // Long enough to defeat the small-string optimization, so each value owns a heap buffer
+    for (uint64_t i = 0; i < n; i++) { co_yield std::string(32, char('a' + (i % 26))); }
+}
+
+cxx::Generator<uint64_t> throws() {
+    throw std::runtime_error("bench");
+    co_return;
+}
+
+// Baseline: the same sequence as `count`, with a hand-written iterator instead of a coroutine.
+struct Counter {
+    uint64_t n_;
+
+    struct iterator {
+        using value_type = uint64_t;
+        using difference_type = int64_t;
+        uint64_t i_;
+        uint64_t operator*() const { return i_; }
+        iterator& operator++() { return ++i_, *this; }
+        void operator++(int) { ++i_; }
+        bool operator==(iterator const&) const = default;
+    };
+
+    iterator begin() const { return {0}; }
+    iterator end() const { return {n_}; }
+};
+
+// Creation
+
+Bench createDestroy("Generator: create and destroy", [](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) { keep(nothing()); }
+});
+
+Bench createFirstValue("Generator: create and take one value", [](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        auto gen = count(1);
+        keep(*gen.begin());
+    }
+});
+
+// Per-yield, trivial `T`
+
+Bench yieldUInt64("Generator<uint64_t>: per value", [](uint64_t n) {
+    uint64_t sum = 0;
+    for (auto x : count(n)) { sum += x; }
+    keep(sum);
+});
+
+Bench handWrittenUInt64("hand-written iterator: per value", [](uint64_t n) {
+    uint64_t sum = 0;
+    for (auto x : Counter {n}) { sum += x; }
+    keep(sum);
+});
+
+Bench iotaUInt64("std::views::iota: per value", [](uint64_t n) {
+    uint64_t sum = 0;
+    for (auto x : std::views::iota(uint64_t(0), n)) { sum += x; }
+    keep(sum);
+});
+
+// Per-yield, through `std::views` adaptors
+
+Bench viewsOnGenerator("Generator | filter | transform: per value", [](uint64_t n) {
+    std::function<bool(uint64_t)> even = [](uint64_t x) { return !(x & 1); };
+    std::function<uint64_t(uint64_t)> triple = [](uint64_t x) { return x * 3; };
+    uint64_t sum = 0;
+    for (auto x : count(n) | std::views::filter(even) | std::views::transform(triple)) { sum += x; }
+    keep(sum);
+});
+
+Bench viewsOnHandWritten("hand-written | filter | transform: per value", [](uint64_t n) {
+    std::function<bool(uint64_t)> even = [](uint64_t x) { return !(x & 1); };
+    std::function<uint64_t(uint64_t)> triple = [](uint64_t x) { return x * 3; };
+    uint64_t sum = 0;
+    for (auto x : Counter {n} | std::views::filter(even) | std::views::transform(triple)) { sum += x; }
+    keep(sum);
+});
+
+// Per-yield, non-trivial `T`
+
+Bench yieldString("Generator<std::string>: per value", [](uint64_t n) {
+    uint64_t sum = 0;
+    for (auto& s : strings(n)) { sum += s.size(); }
+    keep(sum);
+});
+
+Bench loopString("plain loop building std::string: per value", [](uint64_t n) {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        std::string s(32, char('a' + (i % 26)));
+        keep(s);
+        sum += s.size();
+    }
+    keep(sum);
+});
+
+// Exceptions
+
+Bench exceptionPropagation("Generator: exception thrown out to consumer", [](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        try {
+            for (auto x : throws()) { keep(x); }
+        } catch (std::runtime_error const& e) { keep(e); }
+    }
+});
+
+Bench exceptionPlain("plain function: exception thrown out to caller", [](uint64_t n) {
+    std::function<void()> fn = [] { throw std::runtime_error("bench"); };
+    for (uint64_t i = 0; i < n; i++) {
+        try {
+            fn();
+        } catch (std::runtime_error const& e) { keep(e); }
+    }
+});
+
+// Materialization: `n` values in batches of 1000
+
+constexpr uint64_t kBatch = 1000;
+
+Bench toVector("Generator::to<std::vector>: per value", [](uint64_t n) {
+    for (uint64_t i = 0; i < n; i += kBatch) {
+        auto vec = count(kBatch).to<std::vector<uint64_t>>();
+        keep(vec.data());
+    }
+});
+
+Bench rangesToVector("std::ranges::to<std::vector> on iota: per value", [](uint64_t n) {
+    for (uint64_t i = 0; i < n; i += kBatch) {
+        auto vec = std::views::iota(uint64_t(0), kBatch) | std::ranges::to<std::vector<uint64_t>>();
+        keep(vec.data());
+    }
+});
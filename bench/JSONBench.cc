@@ -0,0 +1,28 @@
+#include "cxx/JSON.h"
+#include "cxx/String.h"
+#include "cxx/test/Bench.h"
+
+#include <cstdint>
+
+using cxx::test::Bench;
+using cxx::test::keep;
+int main(int, char**) { return cxx::test::runBenches(); }
+
+cxx::String const good = R"({"id":12345,"name":"widget","tags":["a","b","c"],"ok":true})";
+cxx::String const bad = R"({"id":12345,"name":"widget","tags":["a","b","c"] "ok":true})";
+
+Bench parseGood("JSON::parse, valid input", [](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) { keep(bool(cxx::JSON::parse(good))); }
+});
+
+Bench tryParseGood("JSON::tryParse, valid input", [](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) { keep(bool(cxx::JSON::tryParse(good))); }
+});
+
+Bench parseBad("JSON::parse, invalid input", [](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) { keep(bool(cxx::JSON::parse(bad))); }
+});
+
+Bench tryParseBad("JSON::tryParse, invalid input", [](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) { keep(bool(cxx::JSON::tryParse(bad))); }
+});
@@ -0,0 +1,125 @@
+#include "cxx/LinkedList.h"
+#include "cxx/Ref.h"
+#include "cxx/test/Bench.h"
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using cxx::test::Bench;
+using cxx::test::keep;
+int main(int, char**) { return cxx::test::runBenches(); }
+
+constexpr int kProducers = 4;
+
+// `n` items in total, from `kProducers` threads, taken by one consumer thread (this one).
+
+Bench mpscQueue("MPSCQueue: 4 producers, 1 consumer", [](uint64_t n) {
+    cxx::MPSCQueue<int> queue;
+    auto item = cxx::Ref<int>::make(1);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; p++) {
+        producers.emplace_back([&queue, item, n, p] {
+            for (uint64_t i = p; i < n; i += kProducers) { queue.push(item); }
+        });
+    }
+    for (uint64_t got = 0; got < n;) {
+        if (auto ref = queue.pop()) {
+            keep(*ref);
+            ++got;
+        }
+    }
+    for (auto& t : producers) { t.join(); }
+});
+
+Bench mutexDequeQueue("std::mutex + std::deque: 4 producers, 1 consumer", [](uint64_t n) {
+    std::mutex mutex;
+    std::deque<cxx::Ref<int>> queue;
+    auto item = cxx::Ref<int>::make(1);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; p++) {
+        producers.emplace_back([&mutex, &queue, item, n, p] {
+            for (uint64_t i = p; i < n; i += kProducers) {
+                std::lock_guard lock(mutex);
+                queue.push_back(item);
+            }
+        });
+    }
+    for (uint64_t got = 0; got < n;) {
+        std::lock_guard lock(mutex);
+        if (!queue.empty()) {
+            keep(*queue.front());
+            queue.pop_front();
+            ++got;
+        }
+    }
+    for (auto& t : producers) { t.join(); }
+});
+
+// `kThreads` threads, each doing `n / kThreads` pop-then-push pairs on a shared stack.
+
+constexpr int kThreads = 4;
+
+Bench treiberStack("TreiberStack: 4 threads, pop + push", [](uint64_t n) {
+    cxx::TreiberStack<int> stack;
+    for (int i = 0; i < 64; i++) { stack.push(cxx::Ref<int>::make(i)); }
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&stack, n] {
+            for (uint64_t i = 0; i < n / kThreads; i++) {
+                if (auto ref = stack.pop()) { stack.push(std::move(ref)); }
+            }
+        });
+    }
+    for (auto& t : threads) { t.join(); }
+});
+
+Bench mutexDequeStack("std::mutex + std::deque: 4 threads, pop + push", [](uint64_t n) {
+    std::mutex mutex;
+    std::deque<cxx::Ref<int>> stack;
+    for (int i = 0; i < 64; i++) { stack.push_back(cxx::Ref<int>::make(i)); }
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&mutex, &stack, n] {
+            for (uint64_t i = 0; i < n / kThreads; i++) {
+                cxx::Ref<int> ref;
+                {
+                    std::lock_guard lock(mutex);
+                    if (stack.empty()) { continue; }
+                    ref = std::move(stack.back());
+                    stack.pop_back();
+                }
+                std::lock_guard lock(mutex);
+                stack.push_back(std::move(ref));
+            }
+        });
+    }
+    for (auto& t : threads) { t.join(); }
+});
+
+// Appending items then iterating over them, `kBatch` at a time (`LinkedList` destroys its nodes
+// recursively, so it can't be made very long).
+
+constexpr uint64_t kBatch = 1000;
+
+Bench linkedListAppendIterate("LinkedList<int>: pushBack + iterate", [](uint64_t n) {
+    for (uint64_t b = 0; b < n; b += kBatch) {
+        cxx::LinkedList<int> list;
+        for (uint64_t i = 0; i < kBatch; i++) { list.pushBack(cxx::Ref<int>::make(int(i))); }
+        int64_t sum = 0;
+        for (int x : list) { sum += x; }
+        keep(sum);
+    }
+});
+
+Bench unrolledListAppendIterate("UnrolledList<int>: pushBack + iterate", [](uint64_t n) {
+    for (uint64_t b = 0; b < n; b += kBatch) {
+        cxx::UnrolledList<int> list;
+        for (uint64_t i = 0; i < kBatch; i++) { list.pushBack(int(i)); }
+        int64_t sum = 0;
+        for (int x : list) { sum += x; }
+        keep(sum);
+    }
+});
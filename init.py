@@ -17,11 +17,25 @@ headers = [
     "StackTrace.h",
     "Exception.h",
     "Ref.h",
+    "LinkedList.h",
+    "SmallVector.h",
     "Generator.h",
+    "Channel.h",
     "String.h",
     "JSON.h",
 ]
 
+# Benchmarks: for each name `X` here, `bench/XBench.cc` is built optimized and without sanitizers,
+# into `build/XBench`.  These are run with `make bench` (and aren't part of `all`).
+benches = [
+    "Exception",
+    "DWARF",
+    "LinkedList",
+    "Generator",
+    "Channel",
+    "JSON",
+]
+
 
 @dataclass
 class Target:
@@ -77,7 +91,7 @@ class Makefile:
 
         # All headers are to be listed as dependencies;
         # not just public ones, but the `detail` headers also.
-        globbed_headers = glob.glob("src/**/*.h")
+        globbed_headers = sorted(glob.glob("src/**/*.h"))
         all_headers = self.add(Target("all_headers", deps=globbed_headers))
 
         def make_test_target_opt(test_prog: str, test_cc: str) -> Target:
@@ -142,6 +156,19 @@ class Makefile:
                 self.targets[suf].deps.append(san_test.name)
                 self.targets[suf].build += " && " + run_cmd(prog_base, suf)
 
+        # Benchmarks, also a separate thing; no sanitizers, and optimized.
+        bench_target = self.add(Target(name="bench", deps=[], build="true"))
+        self.roots.append(bench_target)
+        for name in benches:
+            bench_cc = f"bench/{name}Bench.cc"
+            bench_prog = f"build/{name}Bench"
+            self.add(Target(
+                name=bench_prog,
+                deps=[bench_cc] + [all_headers.name] + [builddir_target.name],
+                build=f"$(CLANG) @compile_flags.txt @bench_flags.txt -o {bench_prog} {bench_cc}"))
+            bench_target.deps.append(bench_prog)
+            bench_target.build += " && " + bench_prog
+
         return self
     
     def print(self) -> None:
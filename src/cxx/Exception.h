@@ -14,8 +14,20 @@ namespace cxx {
 template <class E>
 struct Exception;
 
+template <size_t N>
+class ExceptionMessage;
+
+struct CapturePolicy;
+class CaptureControl;
+struct ThrowSite;
+class ThrowStats;
+
 template <class E>
 void Exception<E>::dump(std::ostream& os) const {
+    if (!traced_) {
+        os << "... (stack trace not captured; capture policy: " << policy_ << ")" << std::endl;
+        return;
+    }
     cxx::StackResolver sr;
     trace_.resolve(sr);
     trace_.dump(os);
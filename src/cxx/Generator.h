@@ -8,3 +8,7 @@ class Generator;
 }
 
 #include "gen/Generator.h"
+#include "gen/groupBy.h"
+#include "gen/mergeSorted.h"
+#include "gen/parallelMap.h"
+#include "gen/prefetch.h"
@@ -3,7 +3,7 @@ static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 // (c) 2024 Steve O'Brien -- MIT License
 
 #include "Concepts.h"
-#include "algo/LinkedList.h"
+#include "algo/SmallVector.h"
 #include "gen/Generator.h"
 #include "ref/Ref.h"
 #include "string/String.h"
@@ -12,6 +12,8 @@ static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 #include <cassert>
 #include <cstddef>
 #include <optional>
+#include <ranges>
+#include <utility>
 
 namespace cxx {
 
@@ -35,19 +37,26 @@ JSON::JSON(std::optional<T> val) : JSON(valueOrNull(val)) {}
 
 JSON::JSON(JSONArrayConvertible auto const& val) : JSON(Ref<ArrayRepr>::make()) {
     auto& arr = dynamic_cast<ArrayRepr&>(*repr_);
-    for (auto const& item : val) { arr.vec_.pushBack(Ref<JSON>::make(item)); }
+    if constexpr (std::ranges::sized_range<decltype(val)>) {
+        arr.vec_.reserve(std::ranges::size(val));
+    }
+    for (auto const& item : val) { arr.vec_.emplaceBack(item); }
+}
+
+JSON const& JSON::operator[](size_t index) const {
+    return dynamic_cast<ArrayRepr const&>(*repr_).vec_[index];
 }
 
 bool JSON::operator==(JSON const& rhs) const { return *repr_ == *rhs.repr_; }
 
 JSON::JSON(Generator<ObjectProp> gen) : JSON(Ref<ObjectRepr>::make()) {
     auto& obj = dynamic_cast<ObjectRepr&>(*repr_);
-    for (auto const& prop : gen) { obj.vec_.pushBack(Ref<ObjectProp>::make(prop)); }
+    for (auto& prop : gen) { obj.vec_.pushBack(std::move(prop)); }
 }
 
 JSON::JSON(ObjectConvertible auto const& map) : JSON(Ref<ObjectRepr>::make()) {
     auto& obj = dynamic_cast<ObjectRepr&>(*repr_);
-    for (auto [key, val] : map) { obj.vec_.pushBack(Ref<ObjectProp>::make(key, JSON(val))); }
+    for (auto const& [key, val] : map) { obj.vec_.emplaceBack(key, JSON(val)); }
 }
 
 bool ObjectProp::operator==(ObjectProp const& rhs) const {
@@ -57,5 +66,6 @@ bool ObjectProp::operator==(ObjectProp const& rhs) const {
 }  // namespace cxx
 
 #include "json/parse.h"
+#include "json/stats.h"
 #include "json/write.h"
 #include <cxx/Ref.h>
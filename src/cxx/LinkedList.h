@@ -0,0 +1,25 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include <cstddef>
+
+namespace cxx {
+
+// Declare types here so IDE considers this file (not a decl/ file) "authoritative"
+template <typename T>
+struct LinkedList;
+template <typename T>
+class MPSCQueue;
+template <typename T>
+class TreiberStack;
+template <typename T, size_t K>
+class UnrolledList;
+
+}  // namespace cxx
+
+#include "algo/LinkedList.h"
+#include "algo/MPSCQueue.h"
+#include "algo/TreiberStack.h"
+#include "algo/UnrolledList.h"
+#include <cxx/Ref.h>
@@ -4,28 +4,40 @@ static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 
 #include "io/Bytes.h"
 #include "io/File.h"
+#include "prog/ELF64.h"
 #include "prog/MachO64.h"
 #include "prog/ObjectFile.h"
 #include "prog/SourceLoc.h"
+#include "prog/SymbolTable.h"
 #include "ref/Ref.h"
 
 #include <cstdint>
 #include <cstdlib>
 #include <cxxabi.h>
+#include <mutex>
 #include <string>
 
 namespace cxx {
 
 Ref<Binary> Binary::open(std::string const& path, uintptr_t vmaSlide) {
     auto file = File::open(path);
-    if (!file) { return {}; }
+    if (!file || file->size_ < 64) { return {}; }  // too small for any header we read
     auto magic = file->cur().u32();
     switch (magic) {
-    case 0xfeedfacf: return Ref<MachOBinary64>::make(file, vmaSlide);
-    default:         return {};
+    case 0xfeedfacf:          return Ref<MachOBinary64>::make(file, vmaSlide);
+    case ElfBinary64::kMagic: return Ref<ElfBinary64>::make(file, vmaSlide);
+    default:                  return {};
     }
 }
 
+SymbolTable const& Binary::symbols() const {
+    std::call_once(symbolsOnce_, [this] {
+        readSymbols(&symbols_);
+        symbols_.finish();
+    });
+    return symbols_;
+}
+
 // region helpers
 std::string demangle(std::string const& sym) {
     std::string ret = sym;
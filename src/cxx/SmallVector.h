@@ -0,0 +1,15 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include <cstddef>
+
+namespace cxx {
+
+// Declare types here so IDE considers this file (not a decl/ file) "authoritative"
+template <typename T, size_t N>
+class SmallVector;
+
+}  // namespace cxx
+
+#include "algo/SmallVector.h"
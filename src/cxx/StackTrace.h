@@ -4,11 +4,19 @@ static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 
 #include "exc/Exception.h"
 #include "prog/DWARF.h"
+#include "prog/FunctionIndex.h"
+#include "prog/LineIndex.h"
 #include "prog/ObjectFile.h"
 #include "prog/SourceLoc.h"
+#include "prog/SymbolIndex.h"
 #include "ref/Ref.h"
+#include "stack/Cache.h"
+#include "stack/CrashHandler.h"
+#include "stack/DebugFiles.h"
 #include "stack/Frame.h"
+#include "stack/Modules.h"
 #include "stack/Resolver.h"
+#include "stack/SymbolIndexCache.h"
 #include "stack/Trace.h"
 
 #include <cstddef>
@@ -16,7 +24,6 @@ static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 #include <dlfcn.h>
 #include <exception>
 #include <iostream>
-#include <map>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -28,17 +35,32 @@ namespace cxx {
 struct StackTrace;
 struct StackFrame;
 struct StackResolver;
+class BinaryCache;
+class CrashHandler;
+class DebugFiles;
+struct Module;
+class ModuleMap;
 
 void StackResolver::findBinaries(std::string const& thisProg) {
-    // minor TODO: looks like `binaries` gets some dupes.
-
-    Ref<Binary> bin;
+    auto& cache = BinaryCache::get();
+    auto add = [this](Ref<Binary> bin) {
+        if (!bin) { return; }
+        for (auto const& known : binaries) {
+            if (known.get() == bin.get()) { return; }
+        }
+        binaries.push_back(std::move(bin));
+    };
 
-    // If the program itself can be opened, add that
-    bin = Binary::open(thisProg, vmaSlide);
-    if (bin) { binaries.push_back(bin); }
+    // If the program itself can be opened, add that, and any separate debug info files
+    auto bin = cache.open(thisProg, vmaSlide);
+    if (bin) {
+        for (auto const& debug : bin->debugFiles()) { add(debug); }
+    }
+    add(std::move(bin));
 
-    // Look for the debugging data under `dSYM` (OSX).
+#if defined(__APPLE__)
+    // Look for the debugging data under `dSYM` (OSX; elsewhere there's none, and a failed probe
+    // would only add an entry to the cache).
     // E.g.: for the program:
     //   [...]/build/StackTraceTests.asan
     // we look for the file:
@@ -52,37 +74,47 @@ void StackResolver::findBinaries(std::string const& thisProg) {
     auto progName = thisProg.substr(slash + 1);
     std::stringstream dwarfName;
     dwarfName << thisProg << ".dSYM/Contents/Resources/DWARF/" << progName;
-    bin = Binary::open(dwarfName.str(), vmaSlide);
-    if (bin) { binaries.push_back(bin); }
-}
-
-void getLocations(std::map<uintptr_t, SourceLoc>* out, Binary const& binary) {
-    Ref<Section> debugLine;
-    Ref<Section> debugLineStr;
-    for (auto section : binary.sections()) {
-        if (section->name() == ".debug_line") { debugLine = section; }
-        if (section->name() == "__debug_line") { debugLine = section; }
-        if (section->name() == ".debug_line_str") { debugLineStr = section; }
-        if (section->name() == "__debug_line_str") { debugLineStr = section; }
-    }
-    if (debugLine && debugLineStr) {
-        try {
-            DWARF::evalLineProg(out, debugLine, debugLineStr);
-        } catch (std::exception const& e) {
-            std::cerr << "cannot decode DWARF: " << e.what() << std::endl;
+    add(cache.open(dwarfName.str(), vmaSlide));
+#endif
+}
+
+LineIndex& Binary::lines() const {
+    std::call_once(linesOnce_, [this] { lines_ = Ref<LineIndex>::make(this); });
+    return *lines_;
+}
+
+std::vector<Ref<Binary>> const& Binary::debugFiles() const {
+    std::call_once(debugFilesOnce_, [this] {
+        for (auto& debug : DebugFiles::get().find(*this)) {
+            if (debug.get() != this) { debugFiles_.push_back(std::move(debug)); }
         }
-    }
+    });
+    return debugFiles_;
+}
+
+FunctionIndex const& Binary::functions() const {
+    std::call_once(functionsOnce_, [this] { functions_ = Ref<FunctionIndex>::make(this); });
+    return *functions_;
+}
+
+SymbolIndex const* Binary::symbolIndex() const {
+    std::call_once(symbolIndexOnce_,
+                   [this] { symbolIndex_ = SymbolIndexCache::get().open(*this); });
+    return symbolIndex_.get();
+}
+
+SourceLoc StackResolver::lineAt(uint64_t vaddr, Binary const& binary) {
+    auto hit = binary.lines().find(vaddr);
+    if (!hit) { return {}; }
+    return {.binary = &binary,
+            .virtualAddr = hit.row->addr,
+            .sourceFile = hit.table->file(*hit.row),
+            .line = hit.row->line,
+            .col = hit.row->col};
 }
 
 SourceLoc StackResolver::findLocation(uintptr_t addr, Binary const& binary) {
-    getLocations(&locs, binary);
-    if (locs.size()) {
-        addr -= binary.vmaSlide_;
-        auto it = locs.upper_bound(addr);
-        --it;
-        if (addr >= it->second.virtualAddr) { return it->second; }
-    }
-    return {};
+    return lineAt(addr - binary.vmaSlide_, binary);
 }
 
 SourceLoc StackResolver::findLocation(uintptr_t addr) {
@@ -93,42 +125,154 @@ SourceLoc StackResolver::findLocation(uintptr_t addr) {
     return {};
 }
 
+std::vector<Binary const*> StackResolver::binariesOf(std::string const& filename) const {
+    std::vector<Binary const*> ret;
+    for (auto const& bin : binaries) {
+        auto const& path = bin->file_->path_;
+        if (path == filename || path.starts_with(filename + ".dSYM/")) {
+            // Separate debug files first: if there are any, the binary is probably stripped
+            for (auto const& debug : bin->debugFiles()) { ret.push_back(debug.get()); }
+            ret.push_back(bin.get());
+        }
+    }
+    return ret;
+}
+
+Binary const* StackResolver::indexedBinaryOf(std::string const& filename) const {
+    for (auto const& bin : binaries) {
+        if (bin->file_->path_ == filename) { return bin->symbolIndex() ? bin.get() : nullptr; }
+    }
+    return nullptr;
+}
+
+uint64_t StackResolver::slideOf(std::string const& filename, uintptr_t loadBase) const {
+    for (auto const& bin : binaries) {
+        if (bin->file_->path_ == filename) { return bin->slideAt(loadBase); }
+    }
+    return vmaSlide;  // e.g. only its `.dSYM` could be opened
+}
+
+SourceLoc StackResolver::findLocation(uintptr_t addr, std::string const& filename,
+                                      uintptr_t loadBase) {
+    auto vaddr = addr - slideOf(filename, loadBase);
+    if (auto const* bin = indexedBinaryOf(filename)) {
+        auto hit = bin->symbolIndex()->line(vaddr);
+        if (!hit) { return {}; }
+        return {.binary = bin,
+                .virtualAddr = hit->addr,
+                .sourceFile = hit->file,
+                .line = hit->line,
+                .col = hit->col};
+    }
+    for (auto const* bin : binariesOf(filename)) {
+        auto ret = lineAt(vaddr, *bin);
+        if (ret) { return ret; }
+    }
+    return {};
+}
+
+char const* StackResolver::findSymbol(uintptr_t addr, std::string const& filename,
+                                      uintptr_t loadBase) {
+    auto vaddr = addr - slideOf(filename, loadBase);
+    if (auto const* bin = indexedBinaryOf(filename)) { return bin->symbolIndex()->symbol(vaddr); }
+    for (auto const* bin : binariesOf(filename)) {
+        if (auto const* sym = bin->symbols().find(vaddr)) { return sym->name; }
+    }
+    return nullptr;
+}
+
+std::vector<FunctionIndex::Scope> StackResolver::findFunctions(uintptr_t addr,
+                                                               std::string const& filename,
+                                                               uintptr_t loadBase) {
+    auto vaddr = addr - slideOf(filename, loadBase);
+    if (auto const* bin = indexedBinaryOf(filename)) {
+        return bin->symbolIndex()->functions(vaddr);
+    }
+    for (auto const* bin : binariesOf(filename)) {
+        auto ret = bin->functions().find(vaddr);
+        if (!ret.empty()) { return ret; }
+    }
+    return {};
+}
+
 void StackFrame::resolve(StackResolver& sr) const {
-    // Use basic DL calls available in [g]libc.
-    // This gets us the symbol and binary file (this program or shared lib).
-    if (filename.empty() || symbol.empty()) {
+    if (caller) { return; }  // filled in by the frame before this
+
+    // Find the binary file (this program or shared lib) from the map of loaded modules;
+    // failing that (e.g. on OSX), use basic DL calls, which also give us an exported symbol.
+    char const* dlSymbol = nullptr;
+    if (filename.empty()) {
+        if (auto const* mod = ModuleMap::get().find(uintptr_t(address))) {
+            filename = mod->path;
+            loadBase = mod->begin;
+        }
+    }
+    if (filename.empty()) {
         Dl_info info;
-        dladdr(address, &info);
-        if (dlerror()) { return; }
+        // Check the result, not `dlerror()`: that could be left over from some earlier call
+        if (!dladdr(address, &info)) { return; }
         if (info.dli_fname) { filename = info.dli_fname; }
-        if (info.dli_sname) {
-            symbol = info.dli_sname;
-            demangled = demangle(symbol.data());
-        }
+        loadBase = uintptr_t(info.dli_fbase);
+        dlSymbol = info.dli_sname;
     }
 
-    // Try to locate this binary and/or companion DWARF files
-    // (.dwo files for separated debug info, or `.dSYM/` dirs on OSX).
+    // Try to locate this binary and/or companion DWARF files (found by build ID or debug link,
+    // or `.dSYM/` dirs on OSX; split DWARF `.dwo`s are found when reading the debug info).
     sr.findBinaries(filename);
 
-    // Search `binaries` for DWARF entries indication source locations
-    this->loc = sr.findLocation((uintptr_t) address);
-}
-
-StackTrace::StackTrace() {
-    void* frameAddr = __builtin_frame_address(0);  // Starting at current frame,
-    auto* nextFramePtr = &this->frame;             // build linked list of frames.
-    while (frameAddr) {                            // Until we hit the end...:
-        void** ptr = (void**) frameAddr;           // start poking around in the stack
-        auto ipNext = ((uintptr_t) (ptr[1]));      // find IP of instruction after call
-        if (!ipNext) { break; }                    // (if no return address, we're at end).
-        void* ip = (void*) (ipNext - 1);           // Back up to last byte of prev instruction
-        auto frame = Ref<StackFrame>::make();      // create a new frame
-        frame->address = ip;                       // set address to (near) the calling insn
-        *nextFramePtr = frame;                     // append frame to the list
-        nextFramePtr = &frame->next;               // ready to append next frame (if any)
-        frameAddr = ptr[0];                        // continue walking the stack
+    // Its symbol table has all functions, not just exported ones; use `dladdr`'s if not found
+    auto const* sym = sr.findSymbol((uintptr_t) address, filename, loadBase);
+    if (!sym) { sym = dlSymbol; }
+    if (sym) {
+        symbol = sym;
+        demangled = demangle(symbol.data());
     }
+
+    // Search this file's binaries for DWARF entries indication source locations
+    this->loc = sr.findLocation((uintptr_t) address, filename, loadBase);
+
+    // Debug info also has any calls inlined here.  This frame becomes the innermost of those;
+    // add a frame after it for each outer one, at the location of the inlined call within it.
+    while (next && next->caller) { next = next->next; }  // from an earlier `resolve`
+    auto scopes = sr.findFunctions((uintptr_t) address, filename, loadBase);
+    auto const outerSymbol = symbol;  // for the real (outermost) function
+    auto const* sf = this;
+    for (size_t i = 0; i < scopes.size(); i++) {
+        if (i) {
+            auto const& call = scopes[i - 1];
+            auto outer = Ref<StackFrame>::make();
+            outer->address = address;
+            outer->filename = filename;
+            outer->loadBase = loadBase;
+            outer->loc = {.binary = loc.binary,
+                          .virtualAddr = loc.virtualAddr,
+                          .sourceFile = call.callFile,
+                          .line = call.callLine,
+                          .col = call.callCol};
+            outer->caller = true;
+            outer->next = sf->next;
+            sf->next = outer;
+            sf = outer.get();
+        }
+        // The symbol table's name (if any) is mangled, so has the full signature; debug info
+        // has only a plain name for some functions (e.g. static ones)
+        sf->inlined = (i + 1 < scopes.size());
+        bool useSymbol = !sf->inlined && !outerSymbol.empty();
+        auto const* name = useSymbol ? outerSymbol.data() : scopes[i].name;
+        if (!*name) { continue; }
+        sf->symbol = name;
+        sf->demangled = demangle(sf->symbol.data());
+    }
+}
+
+StackTrace::StackTrace(size_t maxDepth) noexcept {
+    if (maxDepth > kMaxDepth) { maxDepth = kMaxDepth; }
+    depth_ = detail::walkStack(__builtin_frame_address(0), addrs_, maxDepth);
+}
+
+StackTrace::StackTrace(size_t maxDepth, void* framePtr) noexcept {
+    if (maxDepth > kMaxDepth) { maxDepth = kMaxDepth; }
+    depth_ = detail::walkStack(framePtr, addrs_, maxDepth);
 }
 
 }  // namespace cxx
@@ -56,6 +56,16 @@ template <typename T, class E>
 
     operator bool() const { return ok_; }
 
+    E& error() {
+        assert(!ok_);
+        return result_.e;
+    }
+
+    E const& error() const {
+        assert(!ok_);
+        return result_.e;
+    }
+
     T* operator->() {
         if (!ok_) { throw result_.e; }
         return &result_.t;
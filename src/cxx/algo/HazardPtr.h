@@ -0,0 +1,133 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace cxx::detail {
+
+/**
+ * Minimal hazard pointers (Michael, 2004), for reclaiming nodes of lock-free structures.
+ * Each thread gets one hazard slot: before dereferencing a shared node, a thread publishes
+ * its address in the slot (`protect`), then re-checks that the node is still reachable.
+ * A removed node is `retire`d rather than deleted; it's only freed once no slot refers to it.
+ * Since a protected node can't be freed, its address also can't be reused while protected,
+ * which rules out ABA on CAS loops that protect what they compare against.
+ */
+struct Hazards final {
+    struct Slot final {
+        std::atomic<void const*> ptr_ {nullptr};
+        std::atomic<bool> used_ {false};
+        Slot* next_ {nullptr};  // slots are never freed, only reused; so this never changes
+    };
+
+    struct Retired final {
+        void* ptr_;
+        void (*deleter_)(void*);
+    };
+
+    /** Per-thread state: this thread's slot, and the nodes it has retired. */
+    struct Local final {
+        Slot* slot_ {nullptr};
+        std::vector<Retired> retired_;
+
+        ~Local() {
+            if (!slot_) { return; }
+            slot_->ptr_.store(nullptr, std::memory_order_release);
+            Hazards::get().reclaim(retired_);
+            Hazards::get().adopt(std::move(retired_));  // still protected elsewhere; hand off
+            slot_->used_.store(false, std::memory_order_release);
+        }
+    };
+
+    std::atomic<Slot*> slots_ {nullptr};
+    std::atomic<size_t> slotCount_ {0};
+    std::mutex orphansMutex_;
+    std::vector<Retired> orphans_;  // retired by threads which exited before they could be freed
+
+    static Hazards& get() {
+        static Hazards ret;
+        return ret;
+    }
+
+    ~Hazards() {
+        // Process is exiting, so no slots are in use anymore
+        for (auto& r : orphans_) { r.deleter_(r.ptr_); }
+        auto* slot = slots_.load();
+        while (slot) { delete std::exchange(slot, slot->next_); }
+    }
+
+    static Local& local() {
+        thread_local Local ret;
+        if (!ret.slot_) { ret.slot_ = get().acquireSlot(); }
+        return ret;
+    }
+
+    Slot* acquireSlot() {
+        for (auto* slot = slots_.load(std::memory_order_acquire); slot; slot = slot->next_) {
+            bool expect = false;
+            if (slot->used_.compare_exchange_strong(expect, true)) { return slot; }
+        }
+        auto* slot = new Slot();
+        slot->used_.store(true, std::memory_order_relaxed);
+        slot->next_ = slots_.load(std::memory_order_relaxed);
+        while (!slots_.compare_exchange_weak(slot->next_, slot, std::memory_order_acq_rel)) {}
+        slotCount_.fetch_add(1, std::memory_order_relaxed);
+        return slot;
+    }
+
+    /** Publish `ptr` in this thread's slot.  Caller must then re-validate that it's reachable. */
+    static void protect(void const* ptr) {
+        local().slot_->ptr_.store(ptr, std::memory_order_seq_cst);
+    }
+
+    static void clear() { local().slot_->ptr_.store(nullptr, std::memory_order_release); }
+
+    /** Free `ptr` (with `deleter`) once no thread has it protected. */
+    static void retire(void* ptr, void (*deleter)(void*)) {
+        auto& l = local();
+        l.retired_.push_back({ptr, deleter});
+        // Amortize scans: only when there are clearly more retired nodes than could be protected
+        if (l.retired_.size() >= 2 * get().slotCount_.load(std::memory_order_relaxed) + 16) {
+            get().reclaim(l.retired_);
+        }
+    }
+
+    template <typename T>
+    static void retire(T* ptr) {
+        retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    /** Free whichever of `retired` aren't currently protected; the rest stay in `retired`. */
+    void reclaim(std::vector<Retired>& retired) {
+        {
+            std::lock_guard lock(orphansMutex_);
+            retired.insert(retired.end(), orphans_.begin(), orphans_.end());
+            orphans_.clear();
+        }
+        // Callers unlink nodes with seq_cst ops, which this scan's seq_cst loads are ordered after
+        std::vector<void const*> hazards;
+        for (auto* slot = slots_.load(std::memory_order_acquire); slot; slot = slot->next_) {
+            if (auto* ptr = slot->ptr_.load(std::memory_order_seq_cst)) { hazards.push_back(ptr); }
+        }
+        std::ranges::sort(hazards);
+        std::erase_if(retired, [&](Retired const& r) {
+            if (std::ranges::binary_search(hazards, (void const*) r.ptr_)) { return false; }
+            r.deleter_(r.ptr_);
+            return true;
+        });
+    }
+
+    void adopt(std::vector<Retired> retired) {
+        if (retired.empty()) { return; }
+        std::lock_guard lock(orphansMutex_);
+        orphans_.insert(orphans_.end(), retired.begin(), retired.end());
+    }
+};
+
+}  // namespace cxx::detail
@@ -0,0 +1,62 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "../ref/Ref.h"
+
+#include <atomic>
+#include <utility>
+
+namespace cxx {
+
+/**
+ * Lock-free FIFO queue of `Ref<T>`s with any number of producer threads but a single consumer
+ * (Vyukov's node-based MPSC queue).  `push` is wait-free: one atomic exchange plus one store.
+ *
+ * Memory reclamation needs no extra machinery: only the consumer frees nodes, and only once it
+ * has moved past them, which requires that the producer's last write to that node (the link
+ * to its successor) already happened.
+ *
+ * Caveat: a producer which was preempted between its two steps hides the items pushed after it
+ * until it resumes; `pop` may then return empty even though later pushes have completed.
+ */
+template <typename T>
+class MPSCQueue final {
+    struct Node final {
+        Ref<T> data_ {};
+        std::atomic<Node*> next_ {nullptr};
+    };
+
+    std::atomic<Node*> head_;  // most recently pushed; producers swap themselves in here
+    Node* tail_;               // consumer-owned; a "stub" whose `next_` is the oldest item
+
+public:
+    ~MPSCQueue() {
+        while (tail_) { delete std::exchange(tail_, tail_->next_.load(std::memory_order_acquire)); }
+    }
+
+    MPSCQueue() : head_(new Node()), tail_(head_.load()) {}
+    MPSCQueue(MPSCQueue const&) = delete;
+    MPSCQueue& operator=(MPSCQueue const&) = delete;
+
+    /** Safe to call from any thread. */
+    void push(Ref<T> item) {
+        auto* node = new Node {std::move(item)};
+        auto* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next_.store(node, std::memory_order_release);  // link; now visible to the consumer
+    }
+
+    /** Consumer thread only.  Returns the oldest item, or an empty `Ref` if none is available. */
+    Ref<T> pop() {
+        auto* next = tail_->next_.load(std::memory_order_acquire);
+        if (!next) { return {}; }
+        auto ret = std::move(next->data_);
+        delete std::exchange(tail_, next);  // `next` becomes the new stub
+        return ret;
+    }
+
+    /** Consumer thread only.  True if there's nothing to `pop` right now. */
+    bool empty() const { return !tail_->next_.load(std::memory_order_acquire); }
+};
+
+}  // namespace cxx
@@ -0,0 +1,214 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace cxx {
+
+/**
+ * A contiguous, growable array which keeps up to `N` items inline (no heap allocation),
+ * moving to a heap buffer only when it outgrows that.  Growth always moves items (never copies),
+ * so move-only `T` are fine.  Iterators are plain pointers, so this is a `contiguous_range`.
+ * As with `std::vector`, growing invalidates pointers / references / iterators to items.
+ */
+template <typename T, size_t N = 4>
+class SmallVector final {
+    T* data_;
+    size_t size_ {0};
+    size_t cap_ {N};
+    alignas(T) std::byte inline_[sizeof(T) * (N ? N : 1)];
+
+    T* inlineData() noexcept { return reinterpret_cast<T*>(inline_); }
+    bool isInline() const noexcept { return data_ == reinterpret_cast<T const*>(inline_); }
+
+    static T* allocate(size_t cap) {
+        return static_cast<T*>(::operator new(cap * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    void release() noexcept {
+        if (!isInline()) { ::operator delete(data_, std::align_val_t(alignof(T))); }
+        data_ = inlineData();
+        cap_ = N;
+    }
+
+    // Move items into a new heap buffer of capacity `cap` (which must fit them)
+    void relocate(size_t cap) {
+        auto* buf = allocate(cap);
+        try {
+            std::uninitialized_move(data_, data_ + size_, buf);
+        } catch (...) {
+            ::operator delete(buf, std::align_val_t(alignof(T)));
+            throw;
+        }
+        std::destroy(data_, data_ + size_);
+        release();
+        data_ = buf;
+        cap_ = cap;
+    }
+
+    // Take `rhs`'s items, leaving it empty; assumes we're empty and inline
+    void takeFrom(SmallVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (rhs.isInline()) {
+            std::uninitialized_move(rhs.data_, rhs.data_ + rhs.size_, data_);
+            size_ = rhs.size_;
+            rhs.clear();
+        } else {
+            data_ = std::exchange(rhs.data_, rhs.inlineData());
+            size_ = std::exchange(rhs.size_, 0);
+            cap_ = std::exchange(rhs.cap_, N);
+        }
+    }
+
+    size_t grownCapacity() const noexcept { return cap_ ? cap_ * 2 : 4; }
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = T const&;
+    using iterator = T*;
+    using const_iterator = T const*;
+
+    ~SmallVector() noexcept {
+        clear();
+        release();
+    }
+
+    SmallVector() noexcept : data_(inlineData()) {}
+
+    SmallVector(std::initializer_list<T> items)
+        requires std::copy_constructible<T>
+            : SmallVector() {
+        reserve(items.size());
+        for (auto const& item : items) { pushBack(item); }
+    }
+
+    SmallVector(SmallVector const& rhs)
+        requires std::copy_constructible<T>
+            : SmallVector() {
+        reserve(rhs.size_);
+        std::uninitialized_copy(rhs.begin(), rhs.end(), data_);
+        size_ = rhs.size_;
+    }
+
+    SmallVector(SmallVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>)
+            : SmallVector() {
+        takeFrom(std::move(rhs));
+    }
+
+    SmallVector& operator=(SmallVector const& rhs)
+        requires std::copy_constructible<T>
+    {
+        if (this != &rhs) {
+            clear();
+            reserve(rhs.size_);
+            std::uninitialized_copy(rhs.begin(), rhs.end(), data_);
+            size_ = rhs.size_;
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &rhs) {
+            clear();
+            release();
+            takeFrom(std::move(rhs));
+        }
+        return *this;
+    }
+
+    size_t size() const noexcept { return size_; }
+    size_t capacity() const noexcept { return cap_; }
+    bool empty() const noexcept { return !size_; }
+
+    T* data() noexcept { return data_; }
+    T const* data() const noexcept { return data_; }
+    iterator begin() noexcept { return data_; }
+    iterator end() noexcept { return data_ + size_; }
+    const_iterator begin() const noexcept { return data_; }
+    const_iterator end() const noexcept { return data_ + size_; }
+    const_iterator cbegin() const noexcept { return data_; }
+    const_iterator cend() const noexcept { return data_ + size_; }
+
+    T& operator[](size_t i) noexcept {
+        assert(i < size_);
+        return data_[i];
+    }
+    T const& operator[](size_t i) const noexcept {
+        assert(i < size_);
+        return data_[i];
+    }
+    T& front() noexcept { return (*this)[0]; }
+    T const& front() const noexcept { return (*this)[0]; }
+    T& back() noexcept { return (*this)[size_ - 1]; }
+    T const& back() const noexcept { return (*this)[size_ - 1]; }
+
+    void reserve(size_t cap) {
+        if (cap > cap_) { relocate(cap); }
+    }
+
+    template <typename... A>
+    T& emplaceBack(A&&... args) {
+        if (size_ < cap_) {
+            auto* ret = std::construct_at(data_ + size_, std::forward<A>(args)...);
+            ++size_;
+            return *ret;
+        }
+        // Full.  Construct the new item in the new buffer before moving the old items over,
+        // since `args` might refer to one of those items.
+        auto cap = grownCapacity();
+        auto* buf = allocate(cap);
+        T* ret;
+        try {
+            ret = std::construct_at(buf + size_, std::forward<A>(args)...);
+        } catch (...) {
+            ::operator delete(buf, std::align_val_t(alignof(T)));
+            throw;
+        }
+        try {
+            std::uninitialized_move(data_, data_ + size_, buf);
+        } catch (...) {
+            std::destroy_at(ret);
+            ::operator delete(buf, std::align_val_t(alignof(T)));
+            throw;
+        }
+        std::destroy(data_, data_ + size_);
+        release();
+        data_ = buf;
+        cap_ = cap;
+        ++size_;
+        return *ret;
+    }
+
+    void pushBack(T const& item) { emplaceBack(item); }
+    void pushBack(T&& item) { emplaceBack(std::move(item)); }
+
+    void popBack() noexcept {
+        assert(size_);
+        std::destroy_at(data_ + --size_);
+    }
+
+    /** Destroys all items; keeps the current buffer (and capacity). */
+    void clear() noexcept {
+        std::destroy(data_, data_ + size_);
+        size_ = 0;
+    }
+
+    bool operator==(SmallVector const& rhs) const
+        requires std::equality_comparable<T>
+    {
+        return std::ranges::equal(*this, rhs);
+    }
+};
+
+}  // namespace cxx
@@ -0,0 +1,72 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "../ref/Ref.h"
+#include "HazardPtr.h"
+
+#include <atomic>
+#include <utility>
+
+namespace cxx {
+
+/**
+ * Lock-free LIFO stack (Treiber, 1986) of `Ref<T>`s, safe for any number of pushing and popping
+ * threads; handy e.g. as a free list.  Popped nodes are reclaimed with hazard pointers, which
+ * also protect the pop CAS from ABA (a node can't be freed and its address reused while
+ * another thread is part-way through popping it).
+ */
+template <typename T>
+class TreiberStack final {
+    struct Node final {
+        Ref<T> data_;
+        Node* next_ {nullptr};  // only written before this node is published
+    };
+
+    std::atomic<Node*> top_ {nullptr};
+
+public:
+    ~TreiberStack() {
+        auto* node = top_.load(std::memory_order_acquire);
+        while (node) { delete std::exchange(node, node->next_); }
+    }
+
+    TreiberStack() = default;
+    TreiberStack(TreiberStack const&) = delete;
+    TreiberStack& operator=(TreiberStack const&) = delete;
+
+    bool empty() const { return !top_.load(std::memory_order_acquire); }
+
+    void push(Ref<T> item) {
+        auto* node = new Node {std::move(item)};
+        node->next_ = top_.load(std::memory_order_relaxed);
+        while (!top_.compare_exchange_weak(
+                node->next_, node, std::memory_order_release, std::memory_order_relaxed)) {}
+    }
+
+    /** Pops the most recently pushed item, or returns an empty `Ref` if the stack is empty. */
+    Ref<T> pop() {
+        using detail::Hazards;
+        Node* top = top_.load(std::memory_order_acquire);
+        while (top) {
+            Hazards::protect(top);
+            // Re-check after publishing the hazard: if `top` is still on top then it wasn't
+            // popped (so not retired) before our hazard became visible, and it's safe to read.
+            auto* again = top_.load(std::memory_order_seq_cst);
+            if (again != top) {
+                top = again;
+                continue;
+            }
+            if (top_.compare_exchange_weak(top, top->next_, std::memory_order_seq_cst)) {
+                break;
+            }
+        }
+        Hazards::clear();
+        if (!top) { return {}; }
+        auto ret = std::move(top->data_);  // only we can get here with this `top`
+        Hazards::retire(top);
+        return ret;
+    }
+};
+
+}  // namespace cxx
@@ -0,0 +1,201 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace cxx {
+
+/**
+ * An "unrolled" forward-linked list: each node holds up to `K` items inline, rather than one
+ * `Ref<T>` per node as in `LinkedList`.  That's one allocation per `K` items, and iteration
+ * mostly walks contiguous memory.
+ *
+ * `pushBack` fills nodes front-to-back and `pushFront` fills (new) nodes back-to-front,
+ * so both are O(1).  Items never move once added, so pointers, references and iterators
+ * to items stay valid until the list is cleared or destroyed.
+ */
+template <typename T, size_t K = 16>
+class UnrolledList final {
+    static_assert(K > 0);
+
+    struct Node final {
+        Node* next_ {nullptr};
+        size_t begin_;  // items occupy `[begin_, end_)` of `items_`
+        size_t end_;
+        alignas(T) std::byte items_[sizeof(T) * K];
+
+        explicit Node(size_t pos) : begin_(pos), end_(pos) {}
+        ~Node() { std::destroy(item(begin_), item(end_)); }
+
+        T* item(size_t i) noexcept { return reinterpret_cast<T*>(items_) + i; }
+    };
+
+    Node* front_ {nullptr};
+    Node* back_ {nullptr};
+    size_t size_ {0};
+
+    template <bool Const>
+    struct Iterator final {
+        using iterator_concept = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, T const&, T&>;
+
+        Node* node_ {nullptr};
+        size_t index_ {0};
+
+        reference operator*() const { return *node_->item(index_); }
+        auto* operator->() const { return &**this; }
+
+        Iterator& operator++() {
+            if (++index_ == node_->end_) {
+                node_ = node_->next_;
+                index_ = node_ ? node_->begin_ : 0;
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            auto ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        bool operator==(Iterator const&) const = default;
+
+        operator Iterator<true>() const
+            requires(!Const)
+        {
+            return {node_, index_};
+        }
+    };
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = T const&;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    ~UnrolledList() { clear(); }
+    UnrolledList() noexcept = default;
+
+    // Delegates, so that if a copy throws, the destructor frees the nodes made so far
+    UnrolledList(UnrolledList const& rhs)
+        requires std::copy_constructible<T>
+            : UnrolledList() {
+        for (auto const& item : rhs) { pushBack(item); }
+    }
+
+    UnrolledList(UnrolledList&& rhs) noexcept
+            : front_(std::exchange(rhs.front_, nullptr))
+            , back_(std::exchange(rhs.back_, nullptr))
+            , size_(std::exchange(rhs.size_, 0)) {}
+
+    UnrolledList& operator=(UnrolledList const& rhs)
+        requires std::copy_constructible<T>
+    {
+        if (this != &rhs) {
+            clear();
+            for (auto const& item : rhs) { pushBack(item); }
+        }
+        return *this;
+    }
+
+    UnrolledList& operator=(UnrolledList&& rhs) noexcept {
+        if (this != &rhs) {
+            clear();
+            front_ = std::exchange(rhs.front_, nullptr);
+            back_ = std::exchange(rhs.back_, nullptr);
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return !size_; }
+
+    iterator begin() noexcept { return {front_, front_ ? front_->begin_ : 0}; }
+    iterator end() noexcept { return {}; }
+    const_iterator begin() const noexcept { return {front_, front_ ? front_->begin_ : 0}; }
+    const_iterator end() const noexcept { return {}; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    T& front() noexcept {
+        assert(size_);
+        return *front_->item(front_->begin_);
+    }
+    T const& front() const noexcept { return const_cast<UnrolledList*>(this)->front(); }
+    T& back() noexcept {
+        assert(size_);
+        return *back_->item(back_->end_ - 1);
+    }
+    T const& back() const noexcept { return const_cast<UnrolledList*>(this)->back(); }
+
+    template <typename... A>
+    T& emplaceBack(A&&... args) {
+        // If a new node is needed, it's only linked in after the item is constructed in it,
+        // so a throwing constructor doesn't leave an empty node behind
+        auto* node = back_;
+        std::unique_ptr<Node> fresh;
+        if (!node || node->end_ == K) { node = (fresh = std::make_unique<Node>(0)).get(); }
+        auto* ret = std::construct_at(node->item(node->end_), std::forward<A>(args)...);
+        ++node->end_;
+        if (fresh) {
+            (back_ ? back_->next_ : front_) = fresh.release();
+            back_ = node;
+        }
+        ++size_;
+        return *ret;
+    }
+
+    template <typename... A>
+    T& emplaceFront(A&&... args) {
+        auto* node = front_;
+        std::unique_ptr<Node> fresh;
+        if (!node || node->begin_ == 0) { node = (fresh = std::make_unique<Node>(K)).get(); }
+        auto* ret = std::construct_at(node->item(node->begin_ - 1), std::forward<A>(args)...);
+        --node->begin_;
+        if (fresh) {
+            node->next_ = front_;
+            front_ = fresh.release();
+            if (!back_) { back_ = node; }
+        }
+        ++size_;
+        return *ret;
+    }
+
+    void pushBack(T const& item) { emplaceBack(item); }
+    void pushBack(T&& item) { emplaceBack(std::move(item)); }
+    void pushFront(T const& item) { emplaceFront(item); }
+    void pushFront(T&& item) { emplaceFront(std::move(item)); }
+
+    void clear() noexcept {
+        while (front_) { delete std::exchange(front_, front_->next_); }
+        back_ = nullptr;
+        size_ = 0;
+    }
+
+    bool operator==(UnrolledList const& rhs) const
+        requires std::equality_comparable<T>
+    {
+        if (size_ != rhs.size_) { return false; }
+        auto a = begin();
+        auto b = rhs.begin();
+        for (; a != end(); ++a, ++b) {
+            if (*a != *b) { return false; }
+        }
+        return true;
+    }
+};
+
+}  // namespace cxx
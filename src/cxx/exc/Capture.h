@@ -0,0 +1,93 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+namespace cxx {
+
+/** When an exception should capture a stack trace; see `CaptureControl`. */
+struct CapturePolicy final {
+    enum Mode : uint8_t {
+        ALWAYS,   // every time (the default)
+        FIRST_N,  // only the first `n` times
+        SAMPLED,  // once every `n` times: the 1st, then the `n+1`th, ...
+        NEVER,
+    };
+
+    Mode mode {ALWAYS};
+    uint32_t n {0};
+
+    static CapturePolicy always() { return {ALWAYS, 0}; }
+    static CapturePolicy firstN(uint32_t n) { return {FIRST_N, n}; }
+    static CapturePolicy sampled(uint32_t n) { return {SAMPLED, n}; }
+    static CapturePolicy never() { return {NEVER, 0}; }
+
+    bool operator==(CapturePolicy const&) const = default;
+
+    friend std::ostream& operator<<(std::ostream& os, CapturePolicy const& p) {
+        switch (p.mode) {
+        case ALWAYS:  return os << "always";
+        case FIRST_N: return os << "first " << p.n;
+        case SAMPLED: return os << "1 in " << p.n;
+        case NEVER:   return os << "never";
+        }
+        return os;
+    }
+};
+
+/**
+ * A `CapturePolicy` plus the count of exceptions created under it, so that it can decide
+ * whether each new one gets a trace.  Each exception type `E` has one, `E::capture()`; a
+ * throw site can use its own instead, which takes precedence over the type's (this needs
+ * `E` to have the `Exception(CaptureControl&)` constructor, e.g. `using Exception::Exception;`):
+ *
+ *     static cxx::CaptureControl site {cxx::CapturePolicy::sampled(1000)};
+ *     throw MyException(site) << "...";
+ *
+ * The policy can be changed at any time, from any thread (which also resets the count).
+ */
+class CaptureControl final {
+    // Mode and `n` in one word (mode in the high 32 bits), so they're always read together
+    std::atomic<uint64_t> policy_;
+    std::atomic<uint64_t> count_ {0};
+
+    static uint64_t pack(CapturePolicy policy) { return uint64_t(policy.mode) << 32 | policy.n; }
+
+    static CapturePolicy unpack(uint64_t word) {
+        return {CapturePolicy::Mode(word >> 32), uint32_t(word)};
+    }
+
+public:
+    CaptureControl(CapturePolicy policy = {}) : policy_(pack(policy)) {}
+
+    CapturePolicy policy() const { return unpack(policy_.load(std::memory_order_acquire)); }
+
+    void set(CapturePolicy policy) {
+        // The count is reset before the new policy is published; whoever sees the new policy
+        // sees the reset count too (only exceptions already being created might count after it)
+        count_.store(0, std::memory_order_relaxed);
+        policy_.store(pack(policy), std::memory_order_release);
+    }
+
+    /** Whether the exception being created now should capture its stack trace. */
+    bool shouldCapture() {
+        auto const policy = this->policy();
+        auto const n = policy.n;
+        switch (policy.mode) {
+        case CapturePolicy::ALWAYS: return true;
+        case CapturePolicy::NEVER:  return false;
+        case CapturePolicy::FIRST_N:
+            // Once past `n`, stop bumping the count; so a hot site doesn't keep writing to it
+            if (count_.load(std::memory_order_relaxed) >= n) { return false; }
+            return count_.fetch_add(1, std::memory_order_relaxed) < n;
+        case CapturePolicy::SAMPLED:
+            return !n || count_.fetch_add(1, std::memory_order_relaxed) % n == 0;
+        }
+        return true;
+    }
+};
+
+}  // namespace cxx
@@ -6,10 +6,14 @@ static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 
 #include "../ref/Ref.h"
 #include "../stack/Trace.h"
+#include "Capture.h"
+#include "Message.h"
+#include "Stats.h"
 
 #include <cstddef>
 #include <cxxabi.h>
 #include <exception>
+#include <format>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -25,22 +29,39 @@ struct ExceptionBase : std::exception {
 
 template <class E>
 struct Exception : ExceptionBase {
+    CapturePolicy policy_;  // policy in effect at creation; decided whether to fill in `trace_`
+    bool traced_;
     StackTrace trace_;
-    Ref<std::stringstream> buffer_;
-    std::string mutable what_;
+    ExceptionMessage<> mutable msg_;
 
     ~Exception() override = default;
+
+    /** Captures a stack trace or not according to the type's policy, `E::capture()`. */
     Exception();
 
-    char const* what() const noexcept override {
-        what_ = buffer_->str();
-        return what_.data();
+    /** Captures a stack trace or not according to `site`'s policy instead.  Not inlined, so
+     * that its frame can be left out of the trace; see `ThrowSite`. */
+    [[gnu::noinline]] Exception(CaptureControl& site);
+
+    /** Stack trace capture policy for exceptions of type `E`, unless overridden per site. */
+    static CaptureControl& capture() {
+        static CaptureControl ret;
+        return ret;
     }
 
+    char const* what() const noexcept override { return msg_.c_str(); }
+
     void dump(std::ostream& os = std::cerr) const override;
 
     E const& operator<<(this E const& self, auto&& val) {
-        *self.buffer_ << val;
+        self.msg_.write(val);
+        return self;
+    }
+
+    /** Append to the message as with `std::format`, e.g.: `throw E().format("x={}", x);` */
+    template <typename... A>
+    E const& format(this E const& self, std::format_string<A...> fmt, A&&... args) {
+        self.msg_.format(fmt, std::forward<A>(args)...);
         return self;
     }
 };
@@ -81,10 +102,23 @@ std::terminate_handler ensureUncaughtHandler() {
 }  // namespace detail
 
 template <class E>
-Exception<E>::Exception()
+Exception<E>::Exception() : Exception(capture()) {}
+
+template <class E>
+Exception<E>::Exception(CaptureControl& site)
         : ExceptionBase()
-        , buffer_(Ref<std::stringstream>::make()) {
+        , policy_(site.policy())
+        , traced_(site.shouldCapture())
+        // Captured once, the same way whether traced or only counted, so a site has one key.
+        // Without a full trace, still need the top few frames to tell where we are.
+        , trace_(traced_                       ? StackTrace::kMaxDepth
+                 : ThrowStats::get().enabled() ? ThrowSite::kDepth
+                                               : 0,
+                 __builtin_frame_address(0)) {
     detail::ensureUncaughtHandler();
-};
+    auto& stats = ThrowStats::get();
+    if (stats.enabled() && trace_.size()) { stats.record(typeid(E), trace_); }
+    if (!traced_) { trace_.depth_ = 0; }  // only taken for the stats
+}
 
 }  // namespace cxx
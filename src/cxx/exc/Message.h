@@ -0,0 +1,157 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "../Concepts.h"
+#include "../algo/SmallVector.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <ios>
+#include <iterator>
+#include <sstream>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace cxx {
+
+/**
+ * Text of an exception message.  Up to `N` chars (including a terminating NUL) are stored
+ * inline, so typical messages are built without allocating; longer ones spill to the heap.
+ * The contents are kept NUL-terminated, so `c_str()` (and so `what()`) doesn't need a copy.
+ */
+template <size_t N = 128>
+class ExceptionMessage final {
+    SmallVector<char, N> buf_;  // message chars, then a NUL; or empty if nothing written yet
+
+    /** Stream format state, kept across `write`s (as a stream would), e.g. after `std::hex`. */
+    struct Format final {
+        std::ios_base::fmtflags flags;
+        std::streamsize precision;
+        std::streamsize width;
+        char fill;
+        bool operator==(Format const&) const = default;
+    };
+    constexpr static Format kDefaultFormat {std::ios_base::skipws | std::ios_base::dec, 6, 0, ' '};
+    Format fmt_ {kDefaultFormat};
+
+    /** Output iterator appending raw chars; only used between `open()` and `close()`. */
+    struct Appender final {
+        using difference_type = std::ptrdiff_t;
+        SmallVector<char, N>* out_;
+        Appender& operator=(char c) {
+            out_->pushBack(c);
+            return *this;
+        }
+        Appender& operator*() { return *this; }
+        Appender& operator++() { return *this; }
+        Appender operator++(int) { return *this; }
+    };
+
+    /** Drop the NUL (if any) and make room for `more` chars plus a new NUL. */
+    void open(size_t more = 0) {
+        if (!buf_.empty()) { buf_.popBack(); }
+        auto need = buf_.size() + more + 1;
+        if (need > buf_.capacity()) { buf_.reserve(std::max(need, 2 * buf_.capacity())); }
+    }
+
+    void close() { buf_.pushBack('\0'); }
+
+    template <typename T>
+    constexpr static bool kChar = std::is_same_v<T, char> || std::is_same_v<T, signed char>
+                               || std::is_same_v<T, unsigned char>;
+
+    /** Pointers to chars print as strings, as with `std::ostream`. */
+    template <typename T>
+    constexpr static bool kCharPtr = std::is_pointer_v<T>
+                                  && kChar<std::remove_cv_t<std::remove_pointer_t<T>>>;
+
+    /** Write through a temporary stream in the current format state, and keep what it becomes. */
+    template <typename T>
+    void writeStreamed(T const& val) {
+        std::ostringstream os;
+        os.flags(fmt_.flags);
+        os.precision(fmt_.precision);
+        os.width(fmt_.width);
+        os.fill(fmt_.fill);
+        os << val;
+        fmt_ = {os.flags(), os.precision(), os.width(), os.fill()};
+        append(os.view());
+    }
+
+    template <typename T>
+    void writeNumber(T val) {
+        char tmp[64];
+        std::to_chars_result res;
+        if constexpr (std::is_floating_point_v<T>) {
+            res = std::to_chars(tmp, tmp + sizeof(tmp), val, std::chars_format::general, 6);
+        } else {
+            res = std::to_chars(tmp, tmp + sizeof(tmp), val);
+        }
+        append({tmp, size_t(res.ptr - tmp)});
+    }
+
+public:
+    size_t size() const noexcept { return buf_.empty() ? 0 : buf_.size() - 1; }
+    bool empty() const noexcept { return buf_.size() <= 1; }
+    char const* c_str() const noexcept { return buf_.empty() ? "" : buf_.data(); }
+    std::string_view view() const noexcept { return {c_str(), size()}; }
+
+    void append(std::string_view str) {
+        open(str.size());
+        for (char c : str) { buf_.pushBack(c); }
+        close();
+    }
+
+    /**
+     * Append `val` as `std::ostream::operator<<` would print it.  Strings, chars, numbers, and
+     * pointers are written directly while the format is the default; manipulators (`std::hex`,
+     * `std::setw(4)`, etc.), and any other type with an `operator<<`, go through a temporary
+     * `std::ostringstream`, and format changes apply to later writes too.  A null `char*` is
+     * written as "(null)".
+     */
+    template <typename T>
+    void write(T const& val) {
+        using U = std::remove_cvref_t<T>;
+        if constexpr (kCharPtr<U>) {
+            if (!val) { return append("(null)"); }
+        }
+        if (fmt_ != kDefaultFormat) { return writeStreamed(val); }
+        if constexpr (kCharPtr<U>) {
+            append(std::string_view((char const*) val));
+        } else if constexpr (std::is_convertible_v<T const&, std::string_view>) {
+            append(std::string_view(val));
+        } else if constexpr (kChar<U>) {
+            append({(char const*) &val, 1});
+        } else if constexpr (Bool<U>) {
+            append(val ? "1" : "0");
+        } else if constexpr (std::is_arithmetic_v<U>) {
+            writeNumber(val);
+        } else if constexpr (std::is_pointer_v<U>) {
+            char tmp[2 + 2 * sizeof(void*)] = {'0', 'x'};
+            auto res = std::to_chars(tmp + 2, tmp + sizeof(tmp), (uintptr_t) val, 16);
+            append({tmp, size_t(res.ptr - tmp)});
+        } else {
+            writeStreamed(val);
+        }
+    }
+
+    /** Append text formatted as by `std::format`; the format string is checked at compile time. */
+    template <typename... A>
+    void format(std::format_string<A...> fmt, A&&... args) {
+        open();
+        try {
+            std::format_to(Appender {&buf_}, fmt, std::forward<A>(args)...);
+        } catch (...) {
+            close();
+            throw;
+        }
+        close();
+    }
+};
+
+}  // namespace cxx
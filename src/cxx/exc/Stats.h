@@ -0,0 +1,129 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "../stack/Trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <typeinfo>
+
+namespace cxx {
+
+struct JSON;
+
+/**
+ * Counters for one exception type created at one site.  Sites are told apart by the innermost
+ * `kDepth` return addresses at creation, starting from the caller of `Exception`'s constructor:
+ * `E`'s constructor(s) unless inlined, then the throw site, and maybe a little of its callers.
+ * Once published, only the atomics are ever written.
+ */
+struct ThrowSite final {
+    constexpr static size_t kDepth = 4;
+
+    std::type_info const* type_;
+    size_t depth_ {0};
+    void const* addrs_[kDepth];
+    StackTrace sample_;                 // trace of the first exception seen here
+    std::atomic<uint64_t> count_ {0};   // how many exceptions were created here
+    std::atomic<int64_t> firstNanos_;   // system clock, ns since epoch
+    std::atomic<int64_t> lastNanos_;
+    ThrowSite* next_ {nullptr};         // next in hash bucket
+
+    ThrowSite(std::type_info const& type, StackTrace const& trace)
+            : type_(&type)
+            , depth_(std::min(trace.size(), kDepth))
+            , sample_(trace) {
+        for (size_t i = 0; i < depth_; i++) { addrs_[i] = trace.address(i); }
+    }
+
+    bool matches(std::type_info const& type, StackTrace const& trace) const {
+        if (*type_ != type || depth_ != std::min(trace.size(), kDepth)) { return false; }
+        for (size_t i = 0; i < depth_; i++) {
+            if (addrs_[i] != trace.address(i)) { return false; }
+        }
+        return true;
+    }
+
+    static size_t hash(std::type_info const& type, StackTrace const& trace) {
+        size_t ret = type.hash_code();
+        for (size_t i = 0; i < std::min(trace.size(), kDepth); i++) {
+            ret = (ret ^ std::hash<void const*>()(trace.address(i))) * 0x100000001b3ULL;
+        }
+        return ret;
+    }
+};
+
+/**
+ * Process-wide registry of which `cxx::Exception` types are created, where, and how often;
+ * every `Exception` constructor reports here (while `enabled()`).  The throw path is a hash
+ * lookup in a lock-free table plus relaxed atomic updates; it only allocates the first time a
+ * site is seen.  Sites are never removed, so readers can walk them at any time.
+ */
+class ThrowStats final {
+    constexpr static size_t kBuckets = 256;
+
+    std::atomic<ThrowSite*> buckets_[kBuckets] {};
+    std::atomic<bool> enabled_ {true};
+
+    static int64_t nowNanos() {
+        auto now = std::chrono::system_clock::now().time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+    }
+
+public:
+    static ThrowStats& get() {
+        // Never destroyed, since exceptions might still be created during static destruction
+        static auto* ret = new ThrowStats();
+        return *ret;
+    }
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+    /** Count an exception of `type`, whose site is identified by (the top of) `trace`. */
+    ThrowSite& record(std::type_info const& type, StackTrace const& trace) {
+        auto now = nowNanos();
+        auto& bucket = buckets_[ThrowSite::hash(type, trace) % kBuckets];
+        ThrowSite* fresh = nullptr;
+        auto* head = bucket.load(std::memory_order_acquire);
+        while (true) {
+            ThrowSite* site = head;
+            while (site && !site->matches(type, trace)) { site = site->next_; }
+            if (site) {  // already known (possibly only just added by another thread)
+                delete fresh;
+                site->count_.fetch_add(1, std::memory_order_relaxed);
+                site->lastNanos_.store(now, std::memory_order_relaxed);
+                return *site;
+            }
+            if (!fresh) {
+                fresh = new ThrowSite(type, trace);
+                fresh->count_.store(1, std::memory_order_relaxed);
+                fresh->firstNanos_.store(now, std::memory_order_relaxed);
+                fresh->lastNanos_.store(now, std::memory_order_relaxed);
+            }
+            fresh->next_ = head;
+            if (bucket.compare_exchange_weak(head, fresh, std::memory_order_acq_rel)) {
+                return *fresh;
+            }
+            // Lost a race: `head` is now the current head; re-check in case it's our site
+        }
+    }
+
+    /** Calls `func(ThrowSite const&)` on each site seen so far (in no particular order). */
+    void forEach(auto&& func) const {
+        for (auto const& bucket : buckets_) {
+            auto* site = bucket.load(std::memory_order_acquire);
+            for (; site; site = site->next_) { func(*site); }
+        }
+    }
+
+    /** All sites' stats, as an array of objects; see `json/stats.h`. */
+    JSON json() const;
+};
+
+}  // namespace cxx
@@ -8,8 +8,9 @@ static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 #include <coroutine>
 #include <cstddef>
 #include <exception>
-#include <memory>
+#include <optional>
 #include <ranges>
+#include <utility>
 
 namespace cxx {
 
@@ -18,11 +19,16 @@ class Generator;
 
 template <typename T>
 struct Promise {
-    std::unique_ptr<T> val_ {};
+    // The most-recently yielded value; kept inline in the coroutine frame, so yields don't allocate
+    std::optional<T> val_ {};
     std::exception_ptr exc_;
 
     ~Promise() noexcept = default;
 
+    // Declared so this isn't an aggregate: a coroutine's promise is first tried as
+    // `Promise(args...)`, which would otherwise initialize `val_` from the coroutine's arguments.
+    Promise() noexcept = default;
+
     std::suspend_always initial_suspend() noexcept { return {}; }
     std::suspend_always final_suspend() noexcept { return {}; }
     void return_void() noexcept {}
@@ -30,7 +36,7 @@ struct Promise {
     Generator<T> get_return_object() noexcept { return {this}; }
 
     std::suspend_always yield_value(T&& val) noexcept {
-        val_ = std::move(std::make_unique<T>(std::move(val)));
+        val_.emplace(std::move(val));
         return {};
     }
 };
@@ -68,15 +74,19 @@ struct CoroIterator final : CoroIteratorBase<T> {
 
     virtual bool done() const noexcept { return coro_->done(); }
 
-    T& operator*() const noexcept {
+    T& operator*() const {
         auto& p = coro_->handle.promise();
         if (p.exc_) { std::rethrow_exception(p.exc_); }
         return *p.val_;
     }
 
-    CoroIterator<T>& operator++(int) noexcept { return this->operator++(); }
-    CoroIterator<T>& operator++() noexcept {
+    CoroIterator<T>& operator++(int) { return this->operator++(); }
+    CoroIterator<T>& operator++() {
         coro_->handle.resume();
+        // If the coroutine body threw, it's now finished; surface that exception here
+        // (rather than just ending the iteration), so e.g. a range-`for` sees it.
+        auto& p = coro_->handle.promise();
+        if (p.exc_) { std::rethrow_exception(std::exchange(p.exc_, nullptr)); }
         return *this;
     }
 };
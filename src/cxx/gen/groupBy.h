@@ -0,0 +1,70 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "Generator.h"
+
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+namespace cxx {
+
+/** One run of consecutive values sharing a key; yielded by `groupBy`. */
+template <typename K, typename T>
+struct Group final {
+    K key;
+    Generator<T> values;
+};
+
+namespace detail {
+
+// Yields values from `it` while their key equals `key`.  Each value is moved out and `it` advanced
+// before it's yielded, so `it` never points at a moved-from value if this run is abandoned.
+template <typename T, typename K, typename I, typename E, typename F>
+Generator<T> groupRun(I& it, E const& end, K const& key, F& keyFn) {
+    while (it != end && std::invoke(keyFn, std::as_const(*it)) == key) {
+        T val = std::ranges::iter_move(it);
+        ++it;
+        co_yield std::move(val);
+    }
+}
+
+}  // namespace detail
+
+/** Pipeline stage produced by `groupBy`; apply with `gen | groupBy(...)`. */
+template <typename F>
+struct GroupBy final {
+    F keyFn_;
+};
+
+/**
+ * Splits the source into runs of consecutive values with equal `keyFn(value)`, yielding a
+ * `Group {key, values}` per run.  Values are moved straight from the source into the group's
+ * `values` (no buffering or copying); for that reason a group's values must be consumed before
+ * advancing to the next group.  Whatever is left of a group when advancing is skipped.
+ */
+template <typename F>
+GroupBy<F> groupBy(F keyFn) {
+    return {std::move(keyFn)};
+}
+
+template <std::ranges::input_range S,
+          typename F,
+          typename T = std::ranges::range_value_t<S>,
+          typename K = std::remove_cvref_t<std::invoke_result_t<F&, T const&>>>
+Generator<Group<K, T>> operator|(S source, GroupBy<F> stage) {
+    auto& keyFn = stage.keyFn_;
+    auto it = std::ranges::begin(source);
+    auto const end = std::ranges::end(source);
+    while (it != end) {
+        K key = std::invoke(keyFn, std::as_const(*it));
+        Group<K, T> group {key, detail::groupRun<T>(it, end, key, keyFn)};
+        co_yield std::move(group);
+        while (it != end && std::invoke(keyFn, std::as_const(*it)) == key) { ++it; }
+    }
+}
+
+}  // namespace cxx
@@ -0,0 +1,79 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "Generator.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cxx {
+
+/**
+ * Lazily merge `sources`, each of which is already sorted by `cmp`, into one sorted sequence.
+ * Keeps a binary heap of the sources' current values, so each value costs O(log N) comparisons
+ * for N sources, and nothing is buffered beyond one value per source.  Stable: equivalent values
+ * come out in the order of their sources in `sources`.
+ */
+template <typename T, typename Cmp = std::less<>>
+Generator<T> mergeSorted(std::vector<Generator<T>> sources, Cmp cmp = {}) {
+    std::vector<CoroIterator<T>> its;
+    its.reserve(sources.size());
+    for (auto& src : sources) { its.push_back(src.begin()); }
+
+    // Heap of indexes into `its`, with the smallest current value (lowest index on ties) on top
+    auto after = [&](size_t a, size_t b) {
+        if (cmp(*its[b], *its[a])) { return true; }
+        return !cmp(*its[a], *its[b]) && b < a;
+    };
+    std::vector<size_t> heap;
+    heap.reserve(its.size());
+    for (size_t i = 0; i < its.size(); i++) {
+        if (!its[i].done()) { heap.push_back(i); }
+    }
+    std::ranges::make_heap(heap, after);
+
+    while (!heap.empty()) {
+        std::ranges::pop_heap(heap, after);
+        auto& it = its[heap.back()];
+        co_yield std::move(*it);
+        if ((++it).done()) {
+            heap.pop_back();
+        } else {
+            std::ranges::push_heap(heap, after);
+        }
+    }
+}
+
+/**
+ * Variadic form: `mergeSorted(gen1, gen2, ...)`, or `mergeSorted(gen1, gen2, ..., cmp)`
+ * with a comparator as the last argument.
+ */
+template <typename T, typename... A>
+Generator<T> mergeSorted(Generator<T> first, A... rest) {
+    constexpr auto kSources = 1 + sizeof...(A);
+    using Last = std::tuple_element_t<kSources - 1, std::tuple<Generator<T>, A...>>;
+    if constexpr (!std::is_same_v<Last, Generator<T>>) {
+        // Last argument is the comparator
+        auto args = std::tuple<Generator<T>, A...>(std::move(first), std::move(rest)...);
+        return [&]<size_t... I>(std::index_sequence<I...>) {
+            std::vector<Generator<T>> sources;
+            sources.reserve(kSources - 1);
+            (sources.push_back(std::move(std::get<I>(args))), ...);
+            return mergeSorted(std::move(sources), std::move(std::get<kSources - 1>(args)));
+        }(std::make_index_sequence<kSources - 1>());
+    } else {
+        std::vector<Generator<T>> sources;
+        sources.reserve(kSources);
+        sources.push_back(std::move(first));
+        (sources.push_back(std::move(rest)), ...);
+        return mergeSorted(std::move(sources), std::less<> {});
+    }
+}
+
+}  // namespace cxx
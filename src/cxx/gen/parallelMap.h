@@ -0,0 +1,156 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "Generator.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cxx {
+
+namespace detail {
+
+/**
+ * Shared state for one `parallelMap` stage: a ring of `window` slots, and the worker threads
+ * which pick up inputs from that ring and leave their results in the same slot.
+ * Input number `seq` always lives in slot `seq % window`; the consumer only waits on the oldest
+ * outstanding slot, so results are handed back in source order.
+ */
+template <typename T, typename R, typename F>
+struct ParallelMapState final {
+    struct Slot final {
+        std::optional<T> in_ {};
+        std::optional<R> out_ {};
+        std::exception_ptr exc_ {};
+        bool ready_ {false};
+    };
+
+    F fn_;
+    std::vector<Slot> slots_;
+    std::mutex mutex_;
+    std::condition_variable workCV_;  // workers wait here for inputs (or shutdown)
+    std::condition_variable doneCV_;  // consumer waits here for its next result
+    uint64_t submitted_ {0};          // inputs placed into slots so far
+    uint64_t taken_ {0};              // inputs claimed by workers so far
+    bool stop_ {false};
+    std::vector<std::thread> threads_;
+
+    ParallelMapState(F fn, unsigned workers, size_t window)
+            : fn_(std::move(fn))
+            , slots_(window) {
+        for (unsigned i = 0; i < workers; i++) { threads_.emplace_back([this] { work(); }); }
+    }
+
+    ~ParallelMapState() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;  // inputs not yet claimed are simply dropped
+        }
+        workCV_.notify_all();
+        for (auto& thread : threads_) { thread.join(); }
+    }
+
+    Slot& slot(uint64_t seq) { return slots_[seq % slots_.size()]; }
+
+    void submit(T input) {
+        {
+            std::lock_guard lock(mutex_);
+            slot(submitted_++).in_.emplace(std::move(input));
+        }
+        workCV_.notify_one();
+    }
+
+    R take(uint64_t seq) {
+        std::unique_lock lock(mutex_);
+        auto& s = slot(seq);
+        doneCV_.wait(lock, [&s] { return s.ready_; });
+        s.ready_ = false;
+        if (s.exc_) { std::rethrow_exception(std::exchange(s.exc_, nullptr)); }
+        R ret = std::move(*s.out_);
+        s.out_.reset();
+        return ret;
+    }
+
+    void work() {
+        std::unique_lock lock(mutex_);
+        while (true) {
+            workCV_.wait(lock, [this] { return stop_ || taken_ < submitted_; });
+            if (stop_) { return; }
+            auto& s = slot(taken_++);  // slot can't be reused until the consumer takes it
+            T input = std::move(*s.in_);
+            s.in_.reset();
+            lock.unlock();
+
+            std::optional<R> out;
+            std::exception_ptr exc;
+            try {
+                out.emplace(std::invoke(fn_, std::move(input)));
+            } catch (...) { exc = std::current_exception(); }
+
+            lock.lock();
+            s.out_ = std::move(out);
+            s.exc_ = exc;
+            s.ready_ = true;
+            doneCV_.notify_one();
+        }
+    }
+};
+
+}  // namespace detail
+
+/** Pipeline stage produced by `parallelMap`; apply with `gen | parallelMap(...)`. */
+template <typename F>
+struct ParallelMap final {
+    F fn_;
+    unsigned workers_;
+    size_t window_;
+};
+
+/**
+ * Like `std::views::transform`, but runs `fn` on a pool of `workers` threads.
+ * Up to `window` items are pulled ahead from the source; results are yielded in source order.
+ * The source itself is only ever advanced on the consumer's thread, while `fn` must be safe
+ * to call concurrently.  An exception thrown by `fn` is rethrown to the consumer at that item's
+ * position.  Zero `workers` means one per hardware thread; zero `window` means twice `workers`.
+ */
+template <typename F>
+ParallelMap<F> parallelMap(F fn, unsigned workers = 0, size_t window = 0) {
+    if (!workers) { workers = std::thread::hardware_concurrency(); }
+    if (!workers) { workers = 1; }
+    if (!window) { window = 2 * size_t(workers); }
+    return {std::move(fn), workers, window};
+}
+
+template <std::ranges::input_range S,
+          typename F,
+          typename T = std::ranges::range_value_t<S>,
+          typename R = std::remove_cvref_t<std::invoke_result_t<F&, T&&>>>
+Generator<R> operator|(S source, ParallelMap<F> stage) {
+    auto const window = stage.window_;
+    detail::ParallelMapState<T, R, F> state(std::move(stage.fn_), stage.workers_, window);
+    uint64_t submitted = 0;
+    uint64_t yielded = 0;
+    auto it = std::ranges::begin(source);
+    auto end = std::ranges::end(source);
+    while (true) {
+        for (; it != end && submitted - yielded < window; ++it, ++submitted) {
+            state.submit(std::ranges::iter_move(it));  // keep up to `window` items in flight
+        }
+        if (yielded == submitted) { break; }  // source exhausted and everything handed out
+        co_yield state.take(yielded++);
+    }
+}
+
+}  // namespace cxx
@@ -0,0 +1,136 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "Generator.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cxx {
+
+namespace detail {
+
+/**
+ * Single-producer / single-consumer ring of ready values, used by `prefetch`.
+ * `head_` counts values taken by the consumer, `tail_` counts values published by the producer;
+ * both only ever increase.  The top bit of each is a "closed" flag: on `tail_` it means the
+ * producer is finished (source exhausted or threw), on `head_` that the consumer went away.
+ * Blocking (ring full / empty) uses `std::atomic::wait`; otherwise no locks are involved.
+ */
+template <typename T>
+struct PrefetchRing final {
+    constexpr static uint64_t kClosed = uint64_t(1) << 63;
+
+    std::vector<std::optional<T>> slots_;
+    // Padded rather than `alignas`'ed, as this lives in a coroutine frame, which
+    // doesn't honor over-alignment.  The point is just to keep these on separate cache lines.
+    std::atomic<uint64_t> head_ {0};
+    char pad_[64] {};
+    std::atomic<uint64_t> tail_ {0};
+    std::exception_ptr exc_ {};  // set by the producer before closing `tail_`
+
+    explicit PrefetchRing(size_t depth) : slots_(depth ? depth : 1) {}
+
+    // Producer side.  Returns false if the consumer has gone away.
+    bool push(T val, uint64_t& tail) {
+        while (true) {
+            auto head = head_.load(std::memory_order_acquire);
+            if (head & kClosed) { return false; }
+            if (tail - head < slots_.size()) { break; }
+            head_.wait(head, std::memory_order_acquire);  // full; wait for the consumer
+        }
+        slots_[tail % slots_.size()].emplace(std::move(val));
+        tail_.store(++tail, std::memory_order_release);
+        tail_.notify_one();
+        return true;
+    }
+
+    void close(uint64_t tail, std::exception_ptr exc) {
+        exc_ = std::move(exc);
+        tail_.store(tail | kClosed, std::memory_order_release);
+        tail_.notify_one();
+    }
+
+    // Consumer side.  Returns empty once the producer has closed and all values were taken.
+    std::optional<T> pop(uint64_t& head) {
+        while (true) {
+            auto tail = tail_.load(std::memory_order_acquire);
+            if ((tail & ~kClosed) != head) { break; }
+            if (tail & kClosed) {
+                if (exc_) { std::rethrow_exception(std::exchange(exc_, nullptr)); }
+                return {};
+            }
+            tail_.wait(tail, std::memory_order_acquire);  // empty; wait for the producer
+        }
+        auto& slot = slots_[head % slots_.size()];
+        std::optional<T> ret = std::move(slot);
+        slot.reset();
+        head_.store(++head, std::memory_order_release);
+        head_.notify_one();
+        return ret;
+    }
+
+    void cancel(uint64_t head) {
+        head_.store(head | kClosed, std::memory_order_release);
+        head_.notify_one();
+    }
+};
+
+/** Owns the ring and the producer thread; stops and joins the producer when destroyed. */
+template <typename T>
+struct Prefetcher final {
+    PrefetchRing<T> ring_;
+    uint64_t head_ {0};
+    std::thread thread_;
+
+    template <typename S>
+    Prefetcher(S source, size_t depth)
+            : ring_(depth)
+            , thread_([this, src = std::move(source)] mutable { produce(src); }) {}
+
+    ~Prefetcher() {
+        ring_.cancel(head_);
+        thread_.join();
+    }
+
+    template <typename S>
+    void produce(S& src) {
+        uint64_t tail = 0;
+        std::exception_ptr exc;
+        try {
+            auto end = std::ranges::end(src);
+            for (auto it = std::ranges::begin(src); it != end; ++it) {
+                if (!ring_.push(std::ranges::iter_move(it), tail)) { break; }
+            }
+        } catch (...) { exc = std::current_exception(); }
+        ring_.close(tail, std::move(exc));
+    }
+
+    std::optional<T> next() { return ring_.pop(head_); }
+};
+
+}  // namespace detail
+
+/**
+ * Runs `source` on a dedicated thread, which keeps up to `depth` values ready ahead of
+ * the consumer; the result is an ordinary `Generator` yielding the same values in order.
+ * Useful when producing each value is slow (I/O, decompression, ...), as that work then
+ * overlaps with the consumer's.  An exception from the source is rethrown to the consumer
+ * after the values produced before it.  Abandoning the result stops the producer.
+ */
+template <std::ranges::input_range S, typename T = std::ranges::range_value_t<S>>
+Generator<T> prefetch(S source, size_t depth = 16) {
+    detail::Prefetcher<T> prefetcher(std::move(source), depth);
+    while (auto val = prefetcher.next()) { co_yield std::move(*val); }
+}
+
+}  // namespace cxx
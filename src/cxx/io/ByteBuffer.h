@@ -3,6 +3,7 @@ static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 // (c) 2024 Steve O'Brien -- MIT License
 
 #include "Bytes.h"
+#include "Cursor.h"
 
 #include <cstddef>
 #include <cstdint>
@@ -12,11 +13,19 @@ namespace cxx {
 struct Cursor;
 struct File;
 
+/** Bytes in memory owned by this (unlike a `File`'s, which are mapped); e.g. inflated data. */
 struct ByteBuffer final : Bytes {
-    uint8_t const* const data_;
+    uint8_t* const data_;
     size_t const size_;
+
     ByteBuffer(size_t size) : data_(new uint8_t[size]), size_(size) {}
+    ByteBuffer(ByteBuffer const&) = delete;
+    ByteBuffer& operator=(ByteBuffer const&) = delete;
+    ~ByteBuffer() override { delete[] data_; }
+
     Cursor cur() const override;
 };
 
+Cursor ByteBuffer::cur() const { return {this, data_, size_}; }
+
 }  // namespace cxx
@@ -122,7 +122,8 @@ struct Cursor final {
     void operator=(size_t offset) { offset_ = offset; }
     void operator+=(size_t skip) { offset_ += skip; }
 
-    Cursor operator+(size_t adj) const { return {owner_, base_ + adj, size_ - adj}; }
+    /** New cursor starting `adj` bytes past this one's current position. */
+    Cursor operator+(size_t adj) const { return {owner_, base_ + offset_ + adj, size_ - offset_ - adj}; }
 
     // clang-format on
 };
@@ -13,30 +13,48 @@ static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 #include <string>
 #include <sys/fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 namespace cxx {
 
+/**
+ * A file, mapped read-only.  Only regular, non-empty files which could be mapped are valid (and
+ * returned by `open`): not directories, devices, or empty placeholders.
+ */
 struct File : Bytes {
     std::string path_;
     int const fd_;
     size_t const size_;
-    void const* const mmap_;
+    void const* const mmap_;  // nullptr if not mapped
+
+    /** Size of the file open as `fd`, if it's a regular file; else 0. */
+    static size_t regularSize(int fd) {
+        struct stat st {};
+        if (fd == -1 || ::fstat(fd, &st) || !S_ISREG(st.st_mode)) { return 0; }
+        return size_t(st.st_size);
+    }
+
+    static void const* map(int fd, size_t size) {
+        if (!size) { return nullptr; }
+        auto* ret = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        return (ret == MAP_FAILED) ? nullptr : ret;
+    }
 
     virtual ~File() {
-        ::close(fd_);
-        ::munmap((void*) mmap_, size_);
+        if (mmap_) { ::munmap((void*) mmap_, size_); }
+        if (fd_ != -1) { ::close(fd_); }
     }
 
-    bool valid() const { return fd_ != -1; }
+    bool valid() const { return mmap_; }
 
     Cursor cur() const override;
 
     File(std::string path)
             : path_(path)
-            , fd_(::open(path.data(), O_RDONLY))
-            , size_(fd_ == -1 ? 0 : ::lseek(fd_, 0, SEEK_END))
-            , mmap_(fd_ == -1 ? nullptr : ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0)) {}
+            , fd_(::open(path.data(), O_RDONLY | O_CLOEXEC))
+            , size_(regularSize(fd_))
+            , mmap_(map(fd_, size_)) {}
 
     static Ref<File> open(std::string path) {
         auto ret = Ref<File>::make(path);
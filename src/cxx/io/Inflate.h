@@ -0,0 +1,307 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace cxx {
+
+namespace detail {
+
+/** Reads a DEFLATE stream's bits: least significant first, from a 64-bit buffer. */
+class InflateBits final {
+    uint8_t const* next_;
+    uint8_t const* const end_;
+    uint64_t bits_ {0};
+    unsigned count_ {0};   // valid bits in `bits_`
+    size_t overrun_ {0};  // zero bytes supplied past `end_`, which mustn't actually be used
+
+public:
+    InflateBits(uint8_t const* data, size_t size) : next_(data), end_(data + size) {}
+
+    /** Top up to at least 57 bits, so callers can `peek` up to that many without checking. */
+    void refill() {
+        while (count_ <= 56) {
+            uint64_t byte = 0;
+            if (next_ < end_) {
+                byte = *next_++;
+            } else {
+                ++overrun_;
+            }
+            bits_ |= byte << count_;
+            count_ += 8;
+        }
+    }
+
+    uint32_t peek(unsigned n) const { return uint32_t(bits_ & ((uint64_t(1) << n) - 1)); }
+
+    void drop(unsigned n) {
+        bits_ >>= n;
+        count_ -= n;
+    }
+
+    uint32_t take(unsigned n) {
+        if (count_ < n) { refill(); }
+        auto ret = peek(n);
+        drop(n);
+        return ret;
+    }
+
+    void alignToByte() { drop(count_ & 7); }
+
+    /** Whether more bits were used than there were. */
+    bool overrun() const { return overrun_ * 8 > count_; }
+
+    /** Position (in the input) of the next unused byte; call after `alignToByte`. */
+    uint8_t const* bytePos() const { return next_ - (count_ / 8) + overrun_; }
+};
+
+/**
+ * A canonical Huffman code, as DEFLATE uses: given each symbol's code length, codes are
+ * assigned in order of (length, symbol).  Codes of up to `kFastBits` bits are decoded with one
+ * table lookup; longer (rare) ones, a bit at a time.
+ */
+class Huffman final {
+    constexpr static unsigned kFastBits = 10;
+    constexpr static unsigned kMaxBits = 15;
+
+    std::array<uint16_t, 1 << kFastBits> fast_;  // by the next bits: symbol << 4 | length, or 0
+    std::array<uint16_t, kMaxBits + 1> counts_;  // number of codes of each length
+    std::array<uint16_t, 288> symbols_;          // ordered by code
+
+public:
+    void build(uint8_t const* lengths, size_t n) {
+        counts_.fill(0);
+        for (size_t i = 0; i < n; i++) { ++counts_[lengths[i]]; }
+        counts_[0] = 0;
+        std::array<uint16_t, kMaxBits + 2> offsets;  // in `symbols_`, of each length's first
+        std::array<uint32_t, kMaxBits + 1> codes;    // next code of each length
+        offsets[1] = 0;
+        uint32_t code = 0;
+        int left = 1;
+        for (unsigned len = 1; len <= kMaxBits; len++) {
+            left = (left << 1) - counts_[len];
+            if (left < 0) { throw std::runtime_error("bad deflate code lengths"); }
+            offsets[len + 1] = offsets[len] + counts_[len];
+            codes[len] = code;
+            code = (code + counts_[len]) << 1;
+        }
+
+        fast_.fill(0);
+        for (size_t sym = 0; sym < n; sym++) {
+            unsigned len = lengths[sym];
+            if (!len) { continue; }
+            symbols_[offsets[len]++] = uint16_t(sym);
+            if (len > kFastBits) {
+                ++codes[len];
+                continue;
+            }
+            // Codes are packed starting from their most significant bit, so reversed here
+            uint32_t rev = 0;
+            for (uint32_t c = codes[len]++, i = 0; i < len; i++, c >>= 1) {
+                rev = rev << 1 | (c & 1);
+            }
+            for (uint32_t i = rev; i < fast_.size(); i += 1u << len) {
+                fast_[i] = uint16_t(sym << 4 | len);
+            }
+        }
+    }
+
+    unsigned decode(InflateBits& in) const {
+        in.refill();
+        if (auto entry = fast_[in.peek(kFastBits)]) {
+            in.drop(entry & 15);
+            return entry >> 4;
+        }
+        // Longer than `kFastBits`: walk the code one bit at a time (see zlib's `puff.c`)
+        int code = 0;
+        int first = 0;
+        int index = 0;
+        for (unsigned len = 1; len <= kMaxBits; len++) {
+            code |= int(in.take(1));
+            int count = counts_[len];
+            if (code - count < first) { return symbols_[index + (code - first)]; }
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        throw std::runtime_error("bad deflate code");
+    }
+};
+
+}  // namespace detail
+
+/*
+    DEFLATE (RFC 1951): a series of blocks, each starting with 3 bits:
+    whether it's the last block (1 bit), then its type (2 bits):
+      0: stored: skip to a byte boundary; LEN (u16), NLEN (~LEN), then LEN bytes as they are
+      1: compressed with the fixed Huffman codes
+      2: compressed with Huffman codes given (themselves compressed) at the start of the block
+    Compressed data is literal bytes, and (length, distance) back-references to earlier output.
+    https://www.rfc-editor.org/rfc/rfc1951
+*/
+
+/**
+ * Inflate the raw DEFLATE stream in `[in, in + inSize)` into exactly `outSize` bytes at `out`.
+ * The output itself is the back-reference window, so it's written in place, with no copying
+ * through a separate window.  Throws `std::runtime_error` if the data are bad, or don't come to
+ * `outSize` bytes.  Returns the position after the stream's last (byte-aligned) byte.
+ */
+inline uint8_t const* inflate(uint8_t const* in, size_t inSize, uint8_t* out, size_t outSize) {
+    constexpr static uint16_t kLengthBase[29] = {3,  4,  5,  6,  7,  8,  9,  10,  11,  13,
+                                                 15, 17, 19, 23, 27, 31, 35, 43,  51,  59,
+                                                 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    constexpr static uint8_t kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                                 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    constexpr static uint16_t kDistBase[30] = {
+            1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+            193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    constexpr static uint8_t kDistExtra[30] = {0, 0, 0, 0, 1, 1, 2,  2,  3,  3,  4,  4,  5,  5,  6,
+                                               6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+    // Order in which a dynamic block's code length code lengths are given
+    constexpr static uint8_t kLengthOrder[19] = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                                 11, 4,  12, 3, 13, 2, 14, 1, 15};
+
+    detail::InflateBits bits(in, inSize);
+    detail::Huffman lit, dist;
+    size_t pos = 0;
+    auto fail = [](char const* why) { throw std::runtime_error(why); };
+
+    bool last = false;
+    while (!last) {
+        bits.refill();
+        last = bits.take(1);
+        auto type = bits.take(2);
+
+        if (type == 0) {
+            bits.alignToByte();
+            auto len = bits.take(16);
+            if (bits.take(16) != (~len & 0xffff)) { fail("bad deflate stored block"); }
+            for (; len; len--) {
+                if (pos == outSize) { fail("deflate data longer than expected"); }
+                out[pos++] = uint8_t(bits.take(8));
+            }
+            if (bits.overrun()) { fail("deflate data truncated"); }
+            continue;
+        }
+
+        uint8_t lengths[320];
+        size_t litCount = 288;
+        size_t distCount = 30;
+        if (type == 1) {
+            std::memset(lengths, 8, 144);
+            std::memset(lengths + 144, 9, 112);
+            std::memset(lengths + 256, 7, 24);
+            std::memset(lengths + 280, 8, 8);
+            std::memset(lengths + 288, 5, 30);
+        } else if (type == 2) {
+            litCount = bits.take(5) + 257;
+            distCount = bits.take(5) + 1;
+            auto lengthCount = bits.take(4) + 4;
+            if (litCount > 286 || distCount > 30) { fail("bad deflate block header"); }
+            uint8_t lengthLengths[19] = {};
+            for (size_t i = 0; i < lengthCount; i++) {
+                lengthLengths[kLengthOrder[i]] = uint8_t(bits.take(3));
+            }
+            detail::Huffman lengthCode;
+            lengthCode.build(lengthLengths, 19);
+            for (size_t i = 0; i < litCount + distCount;) {
+                auto sym = lengthCode.decode(bits);
+                if (sym < 16) {
+                    lengths[i++] = uint8_t(sym);
+                    continue;
+                }
+                uint8_t repeat = 0;
+                size_t times;
+                if (sym == 16) {
+                    if (!i) { fail("bad deflate code lengths"); }
+                    repeat = lengths[i - 1];
+                    times = 3 + bits.take(2);
+                } else if (sym == 17) {
+                    times = 3 + bits.take(3);
+                } else {
+                    times = 11 + bits.take(7);
+                }
+                if (i + times > litCount + distCount) { fail("bad deflate code lengths"); }
+                std::memset(lengths + i, repeat, times);
+                i += times;
+            }
+            if (!lengths[256]) { fail("deflate block without an end code"); }
+        } else {
+            fail("bad deflate block type");
+        }
+        lit.build(lengths, litCount);
+        dist.build(lengths + litCount, distCount);
+
+        while (true) {
+            auto sym = lit.decode(bits);
+            if (sym < 256) {
+                if (pos == outSize) { fail("deflate data longer than expected"); }
+                out[pos++] = uint8_t(sym);
+                continue;
+            }
+            if (sym == 256) { break; }  // end of block
+            sym -= 257;
+            if (sym >= 29) { fail("bad deflate length code"); }
+            size_t len = kLengthBase[sym] + bits.take(kLengthExtra[sym]);
+            auto distSym = dist.decode(bits);
+            if (distSym >= 30) { fail("bad deflate distance code"); }
+            size_t distance = kDistBase[distSym] + bits.take(kDistExtra[distSym]);
+            if (distance > pos) { fail("deflate distance too far back"); }
+            if (len > outSize - pos) { fail("deflate data longer than expected"); }
+            auto* to = out + pos;
+            auto const* from = to - distance;
+            if (distance >= len) {
+                std::memcpy(to, from, len);
+            } else {
+                for (size_t i = 0; i < len; i++) { to[i] = from[i]; }  // overlaps: repeats
+            }
+            pos += len;
+        }
+        if (bits.overrun()) { fail("deflate data truncated"); }
+    }
+    if (pos != outSize) { fail("deflate data shorter than expected"); }
+    bits.alignToByte();
+    return bits.bytePos();
+}
+
+/*
+    zlib wrapper (RFC 1950): CMF (method 8 = deflate, and window size) and FLG bytes, which as a
+    big-endian u16 are a multiple of 31; then the DEFLATE stream; then the big-endian Adler-32
+    checksum of the inflated data.
+    https://www.rfc-editor.org/rfc/rfc1950
+*/
+
+/** Inflate a zlib stream into exactly `outSize` bytes at `out`; see `inflate`. */
+inline void inflateZlib(uint8_t const* in, size_t inSize, uint8_t* out, size_t outSize) {
+    if (inSize < 6) { throw std::runtime_error("zlib data truncated"); }
+    auto cmf = in[0];
+    auto flg = in[1];
+    if ((cmf & 0x0f) != 8 || (cmf << 8 | flg) % 31 || (flg & 0x20)) {
+        throw std::runtime_error("bad zlib header");
+    }
+    auto const* end = inflate(in + 2, inSize - 6, out, outSize);
+    if (end > in + inSize - 4) { throw std::runtime_error("zlib data truncated"); }
+
+    // Adler-32: sums mod 65521, taken every 5552 bytes: as often as they could overflow
+    uint32_t a = 1;
+    uint32_t b = 0;
+    for (size_t i = 0; i < outSize;) {
+        auto chunk = std::min<size_t>(outSize - i, 5552);
+        for (auto stop = i + chunk; i < stop; i++) {
+            a += out[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    uint32_t expect = uint32_t(end[0]) << 24 | end[1] << 16 | end[2] << 8 | end[3];
+    if ((b << 16 | a) != expect) { throw std::runtime_error("zlib checksum mismatch"); }
+}
+
+}  // namespace cxx
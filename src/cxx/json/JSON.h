@@ -4,7 +4,7 @@ static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 
 #include "../Concepts.h"
 #include "../algo/Expected.h"
-#include "../algo/LinkedList.h"
+#include "../algo/SmallVector.h"
 #include "../exc/Exception.h"
 #include "../gen/Generator.h"
 #include "../ref/Ref.h"
@@ -13,6 +13,7 @@ static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <optional>
 #include <string>
@@ -42,6 +43,36 @@ struct ParseException final : Exception<ParseException> {
     }
 };
 
+/**
+ * A JSON parse failure, as plain data: cheap to create and copy (no stack trace, no allocation).
+ * Call `exception()` for a full `ParseException` (which does capture a trace) if needed.
+ */
+struct ParseError final {
+    enum class Code : uint8_t {
+        UNEXPECTED_CHAR,
+        UNEXPECTED_EOF,
+        UNEXPECTED_DELIMITER,
+        EXPECTED_KEY_VAL,
+    };
+
+    Code code {};
+    unsigned line {0};
+    unsigned col {0};
+    char ch {0};
+
+    char const* message() const noexcept {
+        switch (code) {
+        case Code::UNEXPECTED_CHAR:      return "unexpected";
+        case Code::UNEXPECTED_EOF:       return "unexpected EOF";
+        case Code::UNEXPECTED_DELIMITER: return "unexpected delimiter";
+        case Code::EXPECTED_KEY_VAL:     return "expected key:val";
+        }
+        std::unreachable();
+    }
+
+    ParseException exception() const { return {int(line), int(col), ch, message()}; }
+};
+
 struct JSON;
 struct ObjectProp;
 struct Repr;
@@ -74,7 +105,9 @@ struct JSON final {
     JSON() : JSON(nullptr) {}
     ~JSON() noexcept = default;
     JSON(JSON const&) = default;
+    JSON(JSON&&) noexcept = default;
     JSON& operator=(JSON const&) = default;
+    JSON& operator=(JSON&&) noexcept = default;
 
     JSON(nullptr_t);
     JSON(Bool auto val);
@@ -92,6 +125,9 @@ struct JSON final {
 
     Repr const& val() const noexcept;
 
+    /** Item `index` of this array; throws `std::bad_cast` if this isn't an array. */
+    JSON const& operator[](size_t index) const;
+
     bool operator==(JSON const& rhs) const;
 
     // write.h
@@ -101,6 +137,10 @@ struct JSON final {
     // parse.h
     template <SequenceContainerOf<char> S>
     static Expected<JSON, ParseException> parse(S const& seq);
+
+    /** Like `parse`, but never throws, and failure is just a `ParseError`. */
+    template <SequenceContainerOf<char> S>
+    static Expected<JSON, ParseError> tryParse(S const& seq);
 };
 
 struct NullRepr : Repr {
@@ -134,7 +174,8 @@ struct StringRepr : Repr {
 };
 
 struct ArrayRepr : Repr {
-    LinkedList<JSON> vec_;
+    using Items = SmallVector<JSON, 4>;
+    Items vec_;
 
     ~ArrayRepr() noexcept = default;
     ArrayRepr() noexcept = default;
@@ -151,11 +192,16 @@ struct ObjectProp final {
     ObjectProp() noexcept = default;
     ObjectProp(String key, JSON const& val) noexcept : key_(std::move(key)), val_(val) {}
     ObjectProp(String key, JSON&& val) noexcept : key_(std::move(key)), val_(std::move(val)) {}
+    ObjectProp(ObjectProp const&) = default;
+    ObjectProp(ObjectProp&&) noexcept = default;
+    ObjectProp& operator=(ObjectProp const&) = default;
+    ObjectProp& operator=(ObjectProp&&) noexcept = default;
     bool operator==(ObjectProp const& rhs) const;
 };
 
 struct ObjectRepr : Repr {
-    LinkedList<ObjectProp> vec_;
+    using Props = SmallVector<ObjectProp, 4>;
+    Props vec_;
 
     ~ObjectRepr() noexcept = default;
     ObjectRepr() noexcept = default;
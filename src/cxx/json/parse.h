@@ -9,47 +9,51 @@ static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 
 #include <cassert>
 #include <cstdint>
-#include <sstream>
 #include <string>
 #include <utility>
-#include <vector>
 
 namespace cxx {
 
 namespace detail {
 
+/**
+ * Parser state.  Nothing here throws: on failure, the first error is recorded in `err_`, and
+ * each step returns `false` so that callers unwind immediately.  Successfully-parsed values
+ * are appended to an output list.
+ */
 template <SequenceContainerOf<char> S>
 struct ParseState final {
     constexpr static char kEOF = -1;
     using I = typename S::const_iterator;
+    using Code = ParseError::Code;
 
     unsigned line = 1;
     unsigned col = 1;
     I it_;
     I end_;
+    ParseError err_ {};
 
-    explicit ParseState(S const& seq) {
-        it_ = seq.begin();
-        seq.end();
-    }
+    explicit ParseState(S const& seq) : it_(seq.begin()), end_(seq.end()) {}
 
-    [[gnu::noreturn]] void error(std::string msg) { throw ParseException(line, col, ch(), msg); }
+    bool error(Code code) {
+        err_ = {code, line, col, ch()};
+        return false;
+    }
 
-    [[gnu::noreturn]] void unexpected() { error("unexpected"); }
+    bool unexpected() { return error(eof() ? Code::UNEXPECTED_EOF : Code::UNEXPECTED_CHAR); }
 
     char ch() { return (it_ != end_) ? *it_ : kEOF; }
-    char eof() { return ch() == kEOF; }
+    bool eof() { return it_ == end_; }
 
-    char read() {
-        if (eof()) { error("unexpected EOF"); }
-        char ret = *it_++;
-        if (ret == '\n') {
+    bool read() {
+        if (eof()) { return error(Code::UNEXPECTED_EOF); }
+        if (*it_++ == '\n') {
             col = 1;
             ++line;
         } else {
             ++col;
         }
-        return ret;
+        return true;
     }
 
     void skipSpace() {
@@ -64,105 +68,81 @@ struct ParseState final {
         }
     }
 
-    void expect(char c) {
-        if (ch() != c) { unexpected(); }
-        read();
-    }
+    bool expect(char c) { return ch() == c ? read() : unexpected(); }
 
-    void expect(std::string s) {
-        for (char c : s) { expect(c); }
+    bool expect(char const* s) {
+        for (; *s; ++s) {
+            if (!expect(*s)) { return false; }
+        }
+        return true;
     }
 
-    JSON parseNull();
-    JSON parseBool();
-    JSON parseNumber();
-    JSON parseString();
-    JSON parseArray(unsigned depth);
-    JSON parseObject(unsigned depth);
+    bool parseNull(ArrayRepr::Items& out);
+    bool parseBool(ArrayRepr::Items& out);
+    bool parseNumber(ArrayRepr::Items& out);
+    bool parseString(ArrayRepr::Items& out);
+    bool parseArray(ArrayRepr::Items& out, unsigned depth);
+    bool parseObject(ArrayRepr::Items& out, unsigned depth);
 
-    void parse(std::vector<JSON>& out, unsigned depth);
+    bool parse(ArrayRepr::Items& out, unsigned depth);
 };
 
 }  // namespace detail
 
 template <SequenceContainerOf<char> S>
-Expected<JSON, ParseException> JSON::parse(S const& seq) {
+Expected<JSON, ParseError> JSON::tryParse(S const& seq) {
     detail::ParseState ps(seq);
-    try {
-        std::vector<JSON> result;
-        ps.parse(result, 0);
-        assert(result.size() == 1);
-        return result.front();
-    } catch (ParseException const& exc) { return {exc}; }
+    ArrayRepr::Items result;
+    if (!ps.parse(result, 0)) { return {ps.err_}; }
+    assert(result.size() == 1);
+    return std::move(result.front());
 }
 
 template <SequenceContainerOf<char> S>
-void detail::ParseState<S>::parse(std::vector<JSON>& out, unsigned depth) {
+Expected<JSON, ParseException> JSON::parse(S const& seq) {
+    auto result = tryParse(seq);
+    if (!result) { return result.error().exception(); }
+    return std::move(*result);
+}
+
+template <SequenceContainerOf<char> S>
+bool detail::ParseState<S>::parse(ArrayRepr::Items& out, unsigned depth) {
     skipSpace();
     auto c = ch();
+    if (eof()) { return (depth == 0 && out.size() == 1) || error(Code::UNEXPECTED_EOF); }
     switch (c) {
-
-    case kEOF:
-        if (depth == 0 && out.size() == 1) { return; }
-        error("unexpected EOF");
-
-    case 'n':  // n(ull) token
-        out.push_back(parseNull());
-        break;
-
-    case 't':  // t(rue) or
-    case 'f':  // f(alse) token
-        out.push_back(parseBool());
-        break;
-
-    case '"':  // open quote
-        out.push_back(parseString());
-        break;
-
-    case '[':  // recurse into array
-        out.push_back(parseArray(depth));
-        break;
-
-    case '{':  // recurse into object
-        out.push_back(parseObject(depth));
-        break;
-
-    case ',':  // delimiter for list / object item
-        if (!depth) { error("unexpected delimiter"); }
-        read();  // eat the comma
-        return;  // and return to array/object parsing
-
-    default: {
-        if ((c >= '0' && c <= '9') || c == '-') {
-            out.push_back(parseNumber());
-        } else {
-            unexpected();
-        }
-    }
+    case 'n': return parseNull(out);                     // n(ull) token
+    case 't':                                            // t(rue) or
+    case 'f': return parseBool(out);                     // f(alse) token
+    case '"': return parseString(out);                   // open quote
+    case '[': return parseArray(out, depth);             // recurse into array
+    case '{': return parseObject(out, depth);            // recurse into object
+    case ',':                                            // delimiter for list / object item
+        if (!depth) { return error(Code::UNEXPECTED_DELIMITER); }
+        return read();  // eat the comma, and return to array/object parsing
+    default:
+        if ((c >= '0' && c <= '9') || c == '-') { return parseNumber(out); }
+        return unexpected();
     }
 }
 
 template <SequenceContainerOf<char> S>
-JSON detail::ParseState<S>::parseNull() {
-    expect("null");
-    return JSON {Ref<NullRepr>::make()};
+bool detail::ParseState<S>::parseNull(ArrayRepr::Items& out) {
+    if (!expect("null")) { return false; }
+    out.emplaceBack(Ref<NullRepr>::make());
+    return true;
 }
 
 template <SequenceContainerOf<char> S>
-JSON detail::ParseState<S>::parseBool() {
-    if (ch() == 't') {
-        expect("true");
-        return JSON {Ref<BoolRepr>::make(true)};
-    }
-    if (ch() == 'f') {
-        expect("false");
-        return JSON {Ref<BoolRepr>::make(false)};
-    }
-    std::unreachable();
+bool detail::ParseState<S>::parseBool(ArrayRepr::Items& out) {
+    bool const val = (ch() == 't');
+    if (!expect(val ? "true" : "false")) { return false; }
+    out.emplaceBack(Ref<BoolRepr>::make(val));
+    return true;
 }
 
 template <SequenceContainerOf<char> S>
-JSON detail::ParseState<S>::parseNumber() {
+bool detail::ParseState<S>::parseNumber(ArrayRepr::Items& out) {
     auto digit = [&] { return ch() >= '0' && ch() <= '9'; };
 
     int64_t sign = 1;
@@ -191,73 +171,66 @@ JSON detail::ParseState<S>::parseNumber() {
 
     // TODO exponents
 
-    return sign * (intPart + (fracTop / fracBot));
+    out.emplaceBack(Ref<NumRepr>::make(sign * (intPart + (fracTop / fracBot))));
+    return true;
 }
 
 template <SequenceContainerOf<char> S>
-JSON detail::ParseState<S>::parseString() {
+bool detail::ParseState<S>::parseString(ArrayRepr::Items& out) {
     // TODO escaped sequences!
-    std::stringstream ss;
-    expect('"');           // consume open quote
-    while (ch() != '"') {  // until we reach the close quote
-        ss << read();      // consume char
+    std::string str;
+    if (!expect('"')) { return false; }  // consume open quote
+    while (ch() != '"') {                // until we reach the close quote
+        if (eof()) { return unexpected(); }
+        str += ch();  // consume char
+        read();
     }
-    expect('"');  // consume closing quote
-    return ss.str();
+    if (!expect('"')) { return false; }  // consume closing quote
+    out.emplaceBack(Ref<StringRepr>::make(std::move(str)));
+    return true;
 }
 
 template <SequenceContainerOf<char> S>
-JSON detail::ParseState<S>::parseArray(unsigned depth) {
-    expect('[');              // consume open bracket
-    std::vector<JSON> items;  // build up a list of JSONs
-    goto readItems;
-
-done:
-    read();                          // consume closing bracket
-    return JSON {items};             // return array
-readItems:                           // loop to get zero or more items
-    skipSpace();                     //
-    if (ch() == ']') { goto done; }  // closing bracket: done
-    parse(items, depth + 1);         // get a value (of any JSON type)
-    if (ch() == ']') { goto done; }  // closing bracket: done
-    skipSpace();                     //
-    if (ch() == ',') {               // comma: loop to get more
-        read();                      // consume
-        goto readItems;              // loop
+bool detail::ParseState<S>::parseArray(ArrayRepr::Items& out, unsigned depth) {
+    if (!expect('[')) { return false; }  // consume open bracket
+    auto ret = Ref<ArrayRepr>::make();   // build up a list of JSONs
+    while (true) {
+        skipSpace();
+        if (ch() == ']') { break; }                          // closing bracket: done
+        if (!parse(ret->vec_, depth + 1)) { return false; }  // get a value, appended in place
+        if (ch() == ']') { break; }                          // closing bracket: done
+        skipSpace();
+        if (ch() != ',') { return unexpected(); }  // otherwise need a comma
+        read();                                    // consume; loop to get more
     }
-    unexpected();
+    read();  // consume closing bracket
+    out.emplaceBack(std::move(ret));
+    return true;
 }
 
 template <SequenceContainerOf<char> S>
-JSON detail::ParseState<S>::parseObject(unsigned depth) {
-    expect('{');                         // consume open bracket
+bool detail::ParseState<S>::parseObject(ArrayRepr::Items& out, unsigned depth) {
+    if (!expect('{')) { return false; }  // consume open brace
     auto ret = Ref<ObjectRepr>::make();  // build up a list of properties
-    goto readProps;
-
-done:
-    read();                                                 // consume closing brace
-    return JSON {ret};                                      // done with object
-readProps:                                                  // loop to get zero or more props
-    skipSpace();                                            //
-    if (ch() == '}') { goto done; }                         // closing brace: done
-    auto key = parseString();                               // get the key;
-    auto& keyRepr = dynamic_cast<StringRepr&>(*key.repr_);  // we're expecting a string
-    auto keyStr = keyRepr.val_;                             // actual string
-    skipSpace();                                            //
-    expect(':');                                            // consume colon
-    std::vector<JSON> vals;                                 // "list" of values, expect only 1
-    parse(vals, depth + 1);                                 // get the value (of any JSON type)
-    if (vals.size() != 1) { error("expected key:val"); }    // should have exactly 1 val
-    auto val = std::move(vals.front());                     // get that 1 value (JSON)
-    auto prop = Ref<ObjectProp>::make(keyStr, val);         // make a new prop (ref to ObjectProp)
-    ret->vec_.pushBack(prop);                               // push to this object's prop vector
-    skipSpace();                                            //
-    if (ch() == '}') { goto done; }                         // closing brace: done
-    if (ch() == ',') {                                      // comma: loop to get more props
-        read();                                             // consume
-        goto readProps;                                     // loop
+    while (true) {
+        skipSpace();
+        if (ch() == '}') { break; }  // closing brace: done
+        ArrayRepr::Items kv;         // key, then value
+        if (!parseString(kv)) { return false; }
+        skipSpace();
+        if (!expect(':')) { return false; }
+        if (!parse(kv, depth + 1)) { return false; }
+        if (kv.size() != 2) { return error(Code::EXPECTED_KEY_VAL); }  // should have exactly 1 val
+        auto& key = static_cast<StringRepr const&>(*kv[0].repr_).val_;
+        ret->vec_.emplaceBack(key, std::move(kv[1]));
+        skipSpace();
+        if (ch() == '}') { break; }                // closing brace: done
+        if (ch() != ',') { return unexpected(); }  // otherwise need a comma
+        read();                                    // consume; loop to get more
     }
-    unexpected();
+    read();  // consume closing brace
+    out.emplaceBack(std::move(ret));
+    return true;
 }
 
 }  // namespace cxx
@@ -0,0 +1,53 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "../exc/Stats.h"
+#include "../string/String.h"
+#include "JSON.h"
+
+#include <cstdint>
+#include <ios>
+#include <sstream>
+
+namespace cxx {
+
+namespace detail {
+
+String hexAddress(void const* addr) {
+    std::stringstream ss;
+    ss << "0x" << std::hex << uintptr_t(addr);
+    return ss.str();
+}
+
+JSON addressArray(StackTrace const& trace, size_t count) {
+    auto ret = Ref<ArrayRepr>::make();
+    for (size_t i = 0; i < count; i++) { ret->vec_.emplaceBack(hexAddress(trace.address(i))); }
+    return JSON(std::move(ret));
+}
+
+}  // namespace detail
+
+/**
+ * One object per site:
+ * `{"type", "site": [addrs...], "count", "first", "last", "sample": [addrs...]}`,
+ * where "first" and "last" are in seconds since the epoch (with sub-microsecond precision).
+ */
+JSON ThrowStats::json() const {
+    auto ret = Ref<ArrayRepr>::make();
+    forEach([&](ThrowSite const& site) {
+        auto obj = Ref<ObjectRepr>::make();
+        auto load = [](auto const& val) { return val.load(std::memory_order_relaxed); };
+        auto secs = [](int64_t nanos) { return double(nanos) / 1e9; };
+        obj->vec_.emplaceBack("type", JSON(String(demangle(site.type_->name()))));
+        obj->vec_.emplaceBack("site", detail::addressArray(site.sample_, site.depth_));
+        obj->vec_.emplaceBack("count", JSON(load(site.count_)));
+        obj->vec_.emplaceBack("first", JSON(secs(load(site.firstNanos_))));
+        obj->vec_.emplaceBack("last", JSON(secs(load(site.lastNanos_))));
+        obj->vec_.emplaceBack("sample", detail::addressArray(site.sample_, site.sample_.size()));
+        ret->vec_.emplaceBack(std::move(obj));
+    });
+    return JSON(std::move(ret));
+}
+
+}  // namespace cxx
@@ -2,7 +2,6 @@
 static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 // (c) 2024 Steve O'Brien -- MIT License
 
-#include "../algo/LinkedList.h"
 #include "../string/String.h"
 #include "JSON.h"
 
@@ -21,13 +20,10 @@ std::ostream& JSON::write(std::ostream& os) const {
 void ArrayRepr::write(std::ostream& os) const {
     os << '[';
     String sep = "";
-    auto end = vec_.end();
-    auto it = vec_.begin();
-    while (it != end) {
+    for (auto const& item : vec_) {
         os << sep;
-        (*it).write(os);
+        item.write(os);
         sep = ",";
-        ++it;
     }
     os << ']';
 }
@@ -35,7 +31,7 @@ void ArrayRepr::write(std::ostream& os) const {
 void ObjectRepr::write(std::ostream& os) const {
     os << '{';
     String sep = "";
-    for (auto item : vec_) {
+    for (auto const& item : vec_) {
         os << sep;
         JSON key(item.key_);
         key.write(os);
@@ -0,0 +1,397 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "../io/Cursor.h"
+#include "DWARF.h"
+#include "DWARFForm.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cxx {
+
+/**
+ * An entry in `.debug_info` ("debugging information entry"), with just the attributes we use.
+ * Values are raw, as read; `DIEReader` resolves them to strings, addresses, and so on.
+ */
+struct DIE final {
+    // clang-format off
+    enum : uint64_t {
+        // Tags
+        COMPILE_UNIT = 0x11, SUBPROGRAM = 0x2e, INLINED_SUBROUTINE = 0x1d, SKELETON_UNIT = 0x4a,
+        // Attributes
+        NAME = 0x03, STMT_LIST = 0x10, LOW_PC = 0x11, HIGH_PC = 0x12, COMP_DIR = 0x1b,
+        ABSTRACT_ORIGIN = 0x31, SPECIFICATION = 0x47, RANGES = 0x55, CALL_COLUMN = 0x57,
+        CALL_FILE = 0x58, CALL_LINE = 0x59, LINKAGE_NAME = 0x6e, STR_OFFSETS_BASE = 0x72,
+        ADDR_BASE = 0x73, RNGLISTS_BASE = 0x74, DWO_NAME = 0x76, MIPS_LINKAGE_NAME = 0x2007,
+        // GNU split DWARF, for DWARF 4
+        GNU_DWO_NAME = 0x2130, GNU_DWO_ID = 0x2131, GNU_ADDR_BASE = 0x2133,
+    };
+    // clang-format on
+
+    struct Value final {
+        uint16_t form;
+        uint64_t raw;  // integer value, offset, or index, depending on `form`
+    };
+
+    uint64_t offset {0};  // within `.debug_info`
+    uint64_t tag {0};     // zero for a null entry, which ends a list of children
+    bool children {false};
+    std::optional<Value> name, linkageName, origin, specification, lowPC, highPC, ranges;
+    std::optional<Value> callFile, callLine, callCol, stmtList;
+    std::optional<Value> strOffsetsBase, addrBase, rnglistsBase;
+    std::optional<Value> compDir, dwoName, dwoID;  // a skeleton unit's, for split DWARF
+};
+
+/**
+ * Reads the entries of one compile unit in `.debug_info`.  Construction reads the unit header,
+ * its abbreviations, and the unit's own (top-level) entry; then `next` reads the rest in order.
+ * https://dwarfstd.org/doc/DWARF5.pdf (sections 7.5.1 - 7.5.3)
+ */
+struct DIEReader final {
+    struct AttrSpec final {
+        uint64_t attr;
+        uint16_t form;
+        int64_t implicitConst;
+    };
+
+    struct Abbrev final {
+        uint64_t tag;
+        bool children;
+        std::vector<AttrSpec> attrs;
+    };
+
+    DWARF const& dwarf_;
+    DWARF::UnitHeader unit_;
+    DWARFForm form_;
+    Cursor info_;  // all of `.debug_info`
+    std::optional<Cursor> str_, lineStr_, strOffsets_, addr_, ranges_, rnglists_;
+    std::unordered_map<uint64_t, Abbrev> abbrevs_;  // by code
+    bool compileUnit_ {false};                      // else a type unit, etc., which we skip
+    DIE top_;                                       // the unit's entry
+    Cursor first_;                                  // the entry after that
+    uint64_t baseAddr_ {0};                         // unit's `low_pc`; some ranges are relative
+    uint64_t dwoID_ {0};                            // split DWARF: ties skeleton and split units
+
+    /**
+     * Read the header and top entry of the unit at `offset`.  For a split unit (in a `.dwo` or
+     * `.dwp`, see `SplitDWARF`), pass its skeleton's reader, for the addresses it gives.
+     */
+    DIEReader(DWARF const& dwarf, uint64_t offset, DIEReader const* skeleton = nullptr);
+
+    /** Whether this is a skeleton unit, whose entries are elsewhere; see `SplitDWARF`. */
+    bool skeleton() const { return compileUnit_ && top_.dwoName; }
+
+    bool contains(uint64_t offset) const { return offset >= unit_.offset && offset < unit_.end; }
+    uint64_t end() const { return unit_.end; }
+    uint64_t pos(Cursor const& cur) const { return cur.base_ + cur.offset_ - info_.base_; }
+
+    /** Read the entry at `cur` (into `out`), leaving `cur` after it. */
+    void next(Cursor& cur, DIE* out) const;
+
+    /** The entry at `offset`, which must be in this unit. */
+    DIE at(uint64_t offset) const {
+        auto cur = info_ + offset;
+        DIE ret;
+        next(cur, &ret);
+        return ret;
+    }
+
+    static bool isAddress(uint16_t form);
+    std::string string(DIE::Value const& val) const;
+    uint64_t address(DIE::Value const& val) const;
+
+    /** The `.debug_info` offset an entry-referencing value points to (or nullopt). */
+    std::optional<uint64_t> ref(DIE::Value const& val) const;
+
+    /** Call `fn(begin, end)` for each address range covered by `die`. */
+    template <typename F>
+    void ranges(DIE const& die, F&& fn) const;
+
+private:
+    DIE::Value readValue(Cursor& cur, uint16_t form, int64_t implicitConst) const;
+    uint64_t indexed(std::optional<Cursor> const& table, uint64_t base, uint64_t index,
+                     size_t size) const;
+
+    template <typename F>
+    void rangeList(DIE::Value const& val, F&& fn) const;
+};
+
+/*
+    Compile unit header:
+    v2-4: unit_length, version, debug_abbrev_offset, address_size
+    v5:   unit_length, version, unit_type, address_size, debug_abbrev_offset, [more by type]
+    Abbreviations: (code, tag, has_children, then (attr, form [, implicit const]) pairs until
+    (0, 0)), until code 0.
+*/
+DIEReader::DIEReader(DWARF const& dwarf, uint64_t offset, DIEReader const* skeleton)
+        : dwarf_(dwarf)
+        , info_(dwarf.info_->contents())
+        , first_(info_) {
+    auto cur = info_ + offset;
+    unit_ = DWARF::UnitHeader::read(cur, offset);
+    form_ = {.version = unit_.version, .addrSize = 8, .offsetSize = unit_.offsetSize};
+    uint64_t abbrevOffset;
+    uint8_t unitType = 0x01;
+    if (unit_.version >= 5) {
+        unitType = cur.u8();
+        form_.addrSize = cur.u8();
+        abbrevOffset = form_.offset(cur);
+        if (unitType == 0x04 || unitType == 0x05) { dwoID_ = cur.u64(); }  // skeleton/split
+        if (unitType != 0x01 && unitType != 0x04 && unitType != 0x05) { return; }  // not a CU
+    } else {
+        abbrevOffset = form_.offset(cur);
+        form_.addrSize = cur.u8();
+    }
+    if (unit_.version < 2 || unit_.version > 5 || !dwarf.abbrev_) { return; }
+
+    auto abbrev = dwarf.abbrev_->contents() + abbrevOffset;
+    while (auto code = abbrev.uleb()) {
+        auto& ab = abbrevs_[code];
+        ab.tag = abbrev.uleb();
+        ab.children = abbrev.u8();
+        while (true) {
+            auto attr = abbrev.uleb();
+            auto form = uint16_t(abbrev.uleb());
+            if (!attr && !form) { break; }
+            int64_t implicitConst = (form == DWARFForm::IMPLICIT_CONST) ? abbrev.sleb() : 0;
+            ab.attrs.push_back({attr, form, implicitConst});
+        }
+    }
+
+    auto section = [](Ref<Section> const& sec) -> std::optional<Cursor> {
+        if (!sec) { return std::nullopt; }
+        return sec->contents();
+    };
+    str_ = section(dwarf.str_);
+    lineStr_ = section(dwarf.lineStr_);
+    strOffsets_ = section(dwarf.strOffsets_);
+    addr_ = section(dwarf.addr_);
+    ranges_ = section(dwarf.ranges_);
+    rnglists_ = section(dwarf.rnglists_);
+
+    next(cur, &top_);
+    first_ = cur;
+    compileUnit_ = (top_.tag == DIE::COMPILE_UNIT || top_.tag == DIE::SKELETON_UNIT);
+    if (top_.dwoID) { dwoID_ = top_.dwoID->raw; }
+    // Read these first: the unit's other attributes may be indexes relative to them
+    if (!top_.strOffsetsBase && unit_.version >= 5) {
+        top_.strOffsetsBase = {DWARFForm::SEC_OFFSET, uint64_t(2 * unit_.offsetSize)};
+    }
+    if (skeleton) {
+        // A split unit's addresses are in the skeleton's `.debug_addr`, and its range lists
+        // (if any) follow the header of its own `.debug_rnglists.dwo`
+        if (!top_.addrBase) { top_.addrBase = skeleton->top_.addrBase; }
+        baseAddr_ = skeleton->baseAddr_;
+        if (!top_.rnglistsBase && unitType == 0x05) {
+            top_.rnglistsBase = {DWARFForm::SEC_OFFSET, uint64_t(unit_.offsetSize == 8 ? 20 : 12)};
+        }
+    }
+    if (top_.lowPC) { baseAddr_ = address(*top_.lowPC); }
+}
+
+void DIEReader::next(Cursor& cur, DIE* out) const {
+    *out = {};
+    out->offset = pos(cur);
+    auto code = cur.uleb();
+    if (!code) { return; }
+    auto it = abbrevs_.find(code);
+    if (it == abbrevs_.end()) { throw std::runtime_error("unknown DWARF abbreviation code"); }
+    auto const& ab = it->second;
+    out->tag = ab.tag;
+    out->children = ab.children;
+    for (auto const& spec : ab.attrs) {
+        auto val = readValue(cur, spec.form, spec.implicitConst);
+        switch (spec.attr) {
+        case DIE::NAME:              out->name = val; break;
+        case DIE::LINKAGE_NAME:
+        case DIE::MIPS_LINKAGE_NAME: out->linkageName = val; break;
+        case DIE::ABSTRACT_ORIGIN:   out->origin = val; break;
+        case DIE::SPECIFICATION:     out->specification = val; break;
+        case DIE::LOW_PC:            out->lowPC = val; break;
+        case DIE::HIGH_PC:           out->highPC = val; break;
+        case DIE::RANGES:            out->ranges = val; break;
+        case DIE::CALL_FILE:         out->callFile = val; break;
+        case DIE::CALL_LINE:         out->callLine = val; break;
+        case DIE::CALL_COLUMN:       out->callCol = val; break;
+        case DIE::STMT_LIST:         out->stmtList = val; break;
+        case DIE::STR_OFFSETS_BASE:  out->strOffsetsBase = val; break;
+        case DIE::ADDR_BASE:         out->addrBase = val; break;
+        case DIE::RNGLISTS_BASE:     out->rnglistsBase = val; break;
+        case DIE::GNU_ADDR_BASE:     out->addrBase = val; break;
+        case DIE::COMP_DIR:          out->compDir = val; break;
+        case DIE::DWO_NAME:
+        case DIE::GNU_DWO_NAME:      out->dwoName = val; break;
+        case DIE::GNU_DWO_ID:        out->dwoID = val; break;
+        }
+    }
+}
+
+DIE::Value DIEReader::readValue(Cursor& cur, uint16_t form, int64_t implicitConst) const {
+    switch (form) {
+    case DWARFForm::INDIRECT:       return readValue(cur, uint16_t(cur.uleb()), implicitConst);
+    case DWARFForm::IMPLICIT_CONST: return {form, uint64_t(implicitConst)};
+    case DWARFForm::STRING: {
+        DIE::Value ret {form, pos(cur)};  // where the string is
+        form_.skip(cur, form);
+        return ret;
+    }
+    case DWARFForm::BLOCK:
+    case DWARFForm::BLOCK1:
+    case DWARFForm::BLOCK2:
+    case DWARFForm::BLOCK4:
+    case DWARFForm::EXPRLOC:
+    case DWARFForm::DATA16:
+        form_.skip(cur, form);
+        return {form, 0};
+    }
+    return {form, form_.unsignedValue(cur, form)};
+}
+
+uint64_t DIEReader::indexed(std::optional<Cursor> const& table, uint64_t base, uint64_t index,
+                            size_t size) const {
+    if (!table) { throw std::runtime_error("DWARF index without its section"); }
+    auto cur = *table + (base + index * size);
+    return DWARFForm::sized(cur, size);
+}
+
+std::string DIEReader::string(DIE::Value const& val) const {
+    uint64_t offset = val.raw;
+    switch (val.form) {
+    case DWARFForm::STRING:    return (info_ + offset).str();
+    case DWARFForm::LINE_STRP: return lineStr_ ? (*lineStr_ + offset).str() : "";
+    case DWARFForm::STRP:      break;
+    case DWARFForm::STRX:
+    case DWARFForm::STRX1:
+    case DWARFForm::STRX2:
+    case DWARFForm::STRX3:
+    case DWARFForm::STRX4:
+    case DWARFForm::GNU_STR_INDEX:
+        offset = indexed(strOffsets_, top_.strOffsetsBase->raw, val.raw, unit_.offsetSize);
+        break;
+    default: return {};
+    }
+    return str_ ? (*str_ + offset).str() : "";
+}
+
+bool DIEReader::isAddress(uint16_t form) {
+    switch (form) {
+    case DWARFForm::ADDR:
+    case DWARFForm::ADDRX:
+    case DWARFForm::ADDRX1:
+    case DWARFForm::ADDRX2:
+    case DWARFForm::ADDRX3:
+    case DWARFForm::ADDRX4:
+    case DWARFForm::GNU_ADDR_INDEX: return true;
+    }
+    return false;
+}
+
+uint64_t DIEReader::address(DIE::Value const& val) const {
+    if (val.form == DWARFForm::ADDR || !isAddress(val.form)) { return val.raw; }
+    return indexed(addr_, top_.addrBase ? top_.addrBase->raw : 0, val.raw, form_.addrSize);
+}
+
+std::optional<uint64_t> DIEReader::ref(DIE::Value const& val) const {
+    switch (val.form) {
+    case DWARFForm::REF1:
+    case DWARFForm::REF2:
+    case DWARFForm::REF4:
+    case DWARFForm::REF8:
+    case DWARFForm::REF_UDATA: return unit_.offset + val.raw;
+    case DWARFForm::REF_ADDR:  return val.raw;
+    }
+    return std::nullopt;  // e.g. in a supplementary file, or a type signature
+}
+
+template <typename F>
+void DIEReader::ranges(DIE const& die, F&& fn) const {
+    if (die.lowPC && die.highPC) {
+        auto begin = address(*die.lowPC);
+        auto const& high = *die.highPC;
+        // `high_pc` is an address if given in an address form, else it's the size
+        auto end = isAddress(high.form) ? address(high) : begin + high.raw;
+        if (end > begin) { fn(begin, end); }
+    } else if (die.ranges) {
+        rangeList(*die.ranges, fn);
+    }
+}
+
+/*
+    DWARF 2-4 `.debug_ranges`: (begin, end) address pairs, relative to the unit's base address,
+    until (0, 0); a pair (max address, x) sets the base address to x.
+    DWARF 5 `.debug_rnglists`: entries of a one-byte kind (`DW_RLE_*`) then its operands.
+    https://dwarfstd.org/doc/DWARF5.pdf (section 2.17.3)
+*/
+template <typename F>
+void DIEReader::rangeList(DIE::Value const& val, F&& fn) const {
+    uint64_t base = baseAddr_;
+    if (unit_.version < 5) {
+        if (!ranges_) { return; }
+        auto const maxAddr = (form_.addrSize == 8) ? UINT64_MAX : UINT32_MAX;
+        auto cur = *ranges_ + val.raw;
+        while (true) {
+            auto begin = form_.address(cur);
+            auto end = form_.address(cur);
+            if (!begin && !end) { return; }
+            if (begin == maxAddr) {
+                base = end;
+            } else if (end > begin) {
+                fn(base + begin, base + end);
+            }
+        }
+    }
+
+    if (!rnglists_) { return; }
+    uint64_t offset = val.raw;
+    if (val.form == DWARFForm::RNGLISTX) {
+        auto listsBase = top_.rnglistsBase ? top_.rnglistsBase->raw : 0;
+        offset = listsBase + indexed(rnglists_, listsBase, val.raw, unit_.offsetSize);
+    }
+    auto cur = *rnglists_ + offset;
+    auto addrx = [&](uint64_t index) { return address({DWARFForm::ADDRX, index}); };
+    auto emit = [&](uint64_t begin, uint64_t end) {
+        if (end > begin) { fn(begin, end); }
+    };
+    while (true) {
+        switch (cur.u8()) {
+        case 0: return;                                                  // end_of_list
+        case 1: base = addrx(cur.uleb()); break;                        // base_addressx
+        case 2: {                                                        // startx_endx
+            auto begin = addrx(cur.uleb());
+            emit(begin, addrx(cur.uleb()));
+            break;
+        }
+        case 3: {                                                        // startx_length
+            auto begin = addrx(cur.uleb());
+            emit(begin, begin + cur.uleb());
+            break;
+        }
+        case 4: {                                                        // offset_pair
+            auto begin = base + cur.uleb();
+            emit(begin, base + cur.uleb());
+            break;
+        }
+        case 5: base = form_.address(cur); break;                       // base_address
+        case 6: {                                                        // start_end
+            auto begin = form_.address(cur);
+            emit(begin, form_.address(cur));
+            break;
+        }
+        case 7: {                                                        // start_length
+            auto begin = form_.address(cur);
+            emit(begin, begin + cur.uleb());
+            break;
+        }
+        default: throw std::runtime_error("unknown DWARF range list entry");
+        }
+    }
+}
+
+}  // namespace cxx
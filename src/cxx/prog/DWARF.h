@@ -4,12 +4,15 @@ static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 
 #include "../io/Cursor.h"
 #include "../ref/Ref.h"
+#include "DWARFForm.h"
+#include "LineTable.h"
 #include "ObjectFile.h"
 #include "SourceLoc.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
-#include <map>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -19,77 +22,271 @@ namespace cxx {
 
 struct Section;
 
+/**
+ * The DWARF debug sections of a binary (any of which might be absent), and readers for them.
+ * Each line program unit in `.debug_line` can be decoded on its own; `.debug_aranges` (and the
+ * compile units in `.debug_info`) tell us which one covers a given address.
+ */
 struct DWARF {
-    static void
-    evalLineProg(std::map<uintptr_t, SourceLoc>* out, Ref<Section> debugLine, Ref<Section> debugLineStr);
+    Ref<Section> info_;
+    Ref<Section> abbrev_;
+    Ref<Section> aranges_;
+    Ref<Section> line_;
+    Ref<Section> lineStr_;
+    Ref<Section> str_;
+    Ref<Section> strOffsets_;
+    Ref<Section> addr_;
+    Ref<Section> ranges_;    // DWARF 2-4
+    Ref<Section> rnglists_;  // DWARF 5
+    Ref<Section> cuIndex_;   // in a `.dwp`
+
+    /** An address range `[begin, end)` from `.debug_aranges`, in the unit at `.debug_info+unit` */
+    struct ARange final {
+        uint64_t begin;
+        uint64_t end;
+        uint64_t unit;
+    };
+
+    /** Common start of most units: length (saying whether it's DWARF64), then version. */
+    struct UnitHeader final {
+        uint64_t offset;  // of the unit, within its section
+        uint64_t end;     // offset of the next unit
+        uint16_t version;
+        uint8_t offsetSize;
+
+        static UnitHeader read(Cursor& cur, uint64_t offset);
+    };
+
+    DWARF() = default;
+    explicit DWARF(Binary const& binary);
+
+    /** Offsets of each line program unit in `.debug_line`. */
+    std::vector<uint64_t> lineUnits() const;
+
+    /** Decode the line program unit at `offset` into `out`; call `out->finish()` after. */
+    void evalLineProg(LineTable* out, uint64_t offset) const;
+
+    /** File names in the line program unit at `offset`, indexed by file number. */
+    std::vector<std::string> lineFiles(uint64_t offset) const;
+
+    /** Offsets of each unit in `.debug_info`. */
+    std::vector<uint64_t> infoUnits() const;
+
+    /** All address ranges listed in `.debug_aranges` (empty if none), sorted by address. */
+    std::vector<ARange> aranges() const;
+
+    /** The `DW_AT_stmt_list` of the compile unit at `unit`: its line program's offset. */
+    std::optional<uint64_t> lineUnitOf(uint64_t unit) const;
 };
 
-}  // namespace cxx
+DWARF::DWARF(Binary const& binary) {
+    for (auto const& section : binary.sections()) {
+        auto name = section->name();
+        // ELF names these ".debug_foo"; Mach-O, "__debug_foo" (in the __DWARF segment)
+        if (name.starts_with("__")) { name = "." + name.substr(2); }
+        // Compressed the older GNU way: ".zdebug_foo" (`Section::contents` inflates it)
+        if (name.starts_with(".zdebug_")) { name = "." + name.substr(2); }
+        // Split DWARF (`.dwo` and `.dwp` files) has ".debug_foo.dwo"; see `SplitDWARF`
+        if (name.ends_with(".dwo")) { name.resize(name.size() - 4); }
+        if (name == ".debug_info") { info_ = section; }
+        if (name == ".debug_abbrev") { abbrev_ = section; }
+        if (name == ".debug_aranges") { aranges_ = section; }
+        if (name == ".debug_line") { line_ = section; }
+        if (name == ".debug_line_str") { lineStr_ = section; }
+        if (name == ".debug_str") { str_ = section; }
+        if (name == ".debug_str_offs" || name == ".debug_str_offsets") { strOffsets_ = section; }
+        if (name == ".debug_addr") { addr_ = section; }
+        if (name == ".debug_ranges") { ranges_ = section; }
+        if (name == ".debug_rnglists") { rnglists_ = section; }
+        if (name == ".debug_cu_index") { cuIndex_ = section; }
+    }
+}
 
-namespace cxx {
+DWARF::UnitHeader DWARF::UnitHeader::read(Cursor& cur, uint64_t offset) {
+    UnitHeader ret {.offset = offset, .end = 0, .version = 0, .offsetSize = 4};
+    uint64_t length = cur.u32();
+    if (length == 0xffffffff) {
+        length = cur.u64();
+        ret.offsetSize = 8;
+        ret.end = offset + 12 + length;
+    } else {
+        if (length >= 0xfffffff0) { throw std::runtime_error("reserved DWARF unit length"); }
+        ret.end = offset + 4 + length;
+    }
+    ret.version = cur.u16();
+    return ret;
+}
 
 namespace detail {
 
-void getFilenames(std::vector<std::string>* files, Cursor& data, Cursor const& stringData) {
-    auto str = [&stringData](size_t offset) { return (stringData + offset).str(); };
+/** Offsets of the units (of any kind) in `section`, which are laid end to end. */
+inline std::vector<uint64_t> unitOffsets(Ref<Section> const& section) {
+    std::vector<uint64_t> ret;
+    if (!section) { return ret; }
+    auto const data = section->contents();
+    uint64_t offset = 0;
+    while (offset + 4 <= data.size_) {
+        auto cur = data + offset;
+        auto hdr = DWARF::UnitHeader::read(cur, offset);
+        if (hdr.end > data.size_) { break; }  // truncated
+        ret.push_back(offset);
+        offset = hdr.end;
+    }
+    return ret;
+}
 
-    data.u8(0x01, true, "dirFormatCount");
-    data.u8(0x01, true, "dirFormat");
-    data.u8(0x1f, true, "dirFormatForm");
-    uint64_t dirCount = data.uleb();
+/** Directory and file names from a line program header. */
+struct LineProgFiles final {
     std::vector<std::string> dirs;
-    while (dirCount--) { dirs.push_back(str(data.u32())); }
-
-    data.u8(0x02, true, "fileFormatCount");
-    data.u8(0x01, true, "fileFormat1");
-    data.u8(0x1f, true, "fileFormat1Form");
-    data.u8(0x02, true, "fileFormat2");
-    data.u8(0x0b, true, "fileFormat2Form");
-
-    uint64_t fileCount = data.uleb();
-    while (fileCount--) {
-        auto strID = data.u32();
-        auto dirID = data.uleb();
-        auto file = str(strID);
-        if (file != "<stdin>") { file = dirs[dirID] + "/" + file; }
-        files->push_back(file);
+    std::vector<std::string> files;
+
+    static std::string join(std::string const& dir, std::string const& file) {
+        if (dir.empty() || file.starts_with('/') || file == "<stdin>") { return file; }
+        return dir + "/" + file;
     }
-}
+
+    /** DWARF 2-4: null-terminated lists of strings; files are (name, dir, mtime, size). */
+    void readV4(Cursor& data) {
+        while (data.peekU8()) { dirs.push_back(data.str()); }
+        data.u8();
+        files.push_back({});  // file numbers are 1-based
+        while (data.peekU8()) {
+            auto name = data.str();
+            auto dir = data.uleb();
+            data.uleb();  // mtime
+            data.uleb();  // size
+            // Directory 0 is the compilation dir; not known here, so leave such names relative
+            files.push_back(join((dir && dir <= dirs.size()) ? dirs[dir - 1] : "", name));
+        }
+        data.u8();
+    }
+
+    /** DWARF 5: each list is described by (content type, form) pairs, then has its entries. */
+    void readV5(Cursor& data, DWARFForm const& form, Cursor const* str, Cursor const* lineStr) {
+        constexpr static uint64_t kPath = 1;      // DW_LNCT_path
+        constexpr static uint64_t kDirIndex = 2;  // DW_LNCT_directory_index
+
+        auto readList = [&](auto&& onEntry) {
+            std::vector<std::pair<uint64_t, uint16_t>> format;
+            auto formatCount = data.u8();
+            while (formatCount--) {
+                auto type = data.uleb();
+                format.push_back({type, uint16_t(data.uleb())});
+            }
+            auto count = data.uleb();
+            while (count--) {
+                std::string path;
+                uint64_t dir = 0;
+                for (auto [type, f] : format) {
+                    if (type == kPath) {
+                        path = form.stringValue(data, f, str, lineStr);
+                    } else if (type == kDirIndex) {
+                        dir = form.unsignedValue(data, f);
+                    } else {
+                        form.skip(data, f);
+                    }
+                }
+                onEntry(std::move(path), dir);
+            }
+        };
+
+        readList([&](std::string path, uint64_t) { dirs.push_back(std::move(path)); });
+        readList([&](std::string path, uint64_t dir) {
+            files.push_back(join(dir < dirs.size() ? dirs[dir] : "", path));
+        });
+    }
+};
+
+/** The parts of a line program header needed to run it. */
+struct LineProgHeader final {
+    DWARF::UnitHeader unit;
+    DWARFForm form;
+    unsigned minInstLength;
+    int lineBase;
+    unsigned lineRange;
+    unsigned opcodeBase;
+    std::vector<size_t> opSizes;  // operand counts of standard opcodes; [0] unused
+    LineProgFiles names;
+    Cursor prog;  // the line program itself
+    Cursor end;
+
+    static LineProgHeader read(DWARF const& dwarf, uint64_t offset);
+};
 
 }  // namespace detail
 
-void DWARF::evalLineProg(
-        std::map<uintptr_t, SourceLoc>* out, Ref<Section> debugLine, Ref<Section> debugLineStr) {
-    auto data = debugLine->contents();
-    auto const stringData = debugLineStr->contents();
-
-    auto binary = debugLine->binary();
-
-    auto length = data.u32(0xffffffff, false, "DWARF64 not supported");
-    auto const dataLimit = data + length;
-    data.u16(0x0005, true, "version");
-    data.u8(0x08, true, "address_size");
-    data.u8(0x00, true, "seg_select_size");
-    auto prologueSize = data.u32();
-    data.u8(0x01, true, "min_inst_length");
-    data.u8(0x01, true, "max_ops_per_inst");
-    data += 1;
-
-    auto u8 = [&data]() { return data.u8(); };
-    auto u16 = [&data]() { return data.u16(); };
-    auto u32 = [&data]() { return data.u32(); };
+std::vector<uint64_t> DWARF::lineUnits() const { return detail::unitOffsets(line_); }
+std::vector<uint64_t> DWARF::infoUnits() const { return detail::unitOffsets(info_); }
+
+/*
+    Line program header (https://dwarfstd.org/doc/DWARF5.pdf section 6.2.4):
+    unit_length (4, or 0xffffffff then 8), version (2), [v5: address_size (1), seg_sel_size (1)],
+    header_length (offset size), min_inst_length (1), [v4+: max_ops_per_inst (1)],
+    default_is_stmt (1), line_base (1, signed), line_range (1), opcode_base (1),
+    standard_opcode_lengths (opcode_base - 1), then directories and files (format varies).
+*/
+detail::LineProgHeader detail::LineProgHeader::read(DWARF const& dwarf, uint64_t offset) {
+    auto const sectionData = dwarf.line_->contents();
+    auto data = sectionData + offset;
+    auto unit = DWARF::UnitHeader::read(data, offset);
+    if (unit.version < 2 || unit.version > 5) {
+        auto version = std::to_string(unit.version);
+        throw std::runtime_error("unsupported line program version " + version);
+    }
+
+    DWARFForm form {.version = unit.version, .addrSize = 8, .offsetSize = unit.offsetSize};
+    if (unit.version >= 5) {
+        form.addrSize = data.u8();
+        data.u8();  // seg_select_size
+    }
+    auto headerLength = form.offset(data);
+    auto const progStart = data + headerLength;
+    unsigned minInstLength = data.u8();
+    if (unit.version >= 4) { data.u8(); }  // max_ops_per_inst; VLIW op indexes are ignored
+    data.u8();                              // default_is_stmt
     int lineBase = data.i8();
     unsigned lineRange = data.u8();
     unsigned opcodeBase = data.u8();
+    if (!lineRange) { throw std::runtime_error("line_range is 0"); }
     std::vector<size_t> opSizes {0};  // [0] is 0
-    for (size_t i = 1; i < opcodeBase; i++) { opSizes.push_back(u8()); /* init 1 through 12 */ }
+    for (size_t i = 1; i < opcodeBase; i++) { opSizes.push_back(data.u8()); }
 
-    std::vector<std::string> files;
-    detail::getFilenames(&files, data, stringData);
+    std::optional<Cursor> str;
+    std::optional<Cursor> lineStr;
+    if (dwarf.str_) { str = dwarf.str_->contents(); }
+    if (dwarf.lineStr_) { lineStr = dwarf.lineStr_->contents(); }
+    LineProgFiles names;
+    if (unit.version >= 5) {
+        names.readV5(data, form, str ? &*str : nullptr, lineStr ? &*lineStr : nullptr);
+    } else {
+        names.readV4(data);
+    }
+
+    // Start at `progStart`, skipping anything in the header we didn't understand
+    return {unit, form, minInstLength, lineBase, lineRange, opcodeBase, std::move(opSizes),
+            std::move(names), progStart, sectionData + unit.end};
+}
+
+std::vector<std::string> DWARF::lineFiles(uint64_t offset) const {
+    if (!line_) { return {}; }
+    return detail::LineProgHeader::read(*this, offset).names.files;
+}
+
+void DWARF::evalLineProg(LineTable* out, uint64_t offset) const {
+    auto header = detail::LineProgHeader::read(*this, offset);
+    auto const minInstLength = header.minInstLength;
+    auto const lineBase = header.lineBase;
+    auto const lineRange = header.lineRange;
+    auto const opcodeBase = header.opcodeBase;
+    auto const& opSizes = header.opSizes;
+    auto data = header.prog;
+    auto const dataLimit = header.end;
+    std::vector<uint32_t> fileIDs;
+    for (auto const& file : header.names.files) { fileIDs.push_back(out->intern(file)); }
 
     // Subset of "VM registers"
     uint64_t addr;
-    int32_t fileIndex;
+    uint64_t fileIndex;
     uint32_t line;
     uint32_t col;
 
@@ -102,105 +299,159 @@ void DWARF::evalLineProg(
     };
     reset();
 
-    // Start interpreting commands
-
-    std::stringstream err;
-
     auto append = [&]() {
-        auto sourceFile = (fileIndex >= 0) ? files[fileIndex] : "";
-        // std::printf("addr:%016llx file:%s line:%d col:%d\n", addr, sourceFile.data(), line, col);
-        (*out)[addr] =
-                {.binary = binary, .virtualAddr = addr, .sourceFile = sourceFile, .line = line, .col = col};
+        if (fileIndex >= fileIDs.size()) { return out->addEnd(addr); }
+        out->add(addr, fileIDs[fileIndex], line, col);
     };
 
     auto doStandard = [&](uint8_t op) {
-        // std::printf("op %02x standard\n", op);
-        auto opSize = opSizes[op];
-        uint8_t adjOp, opAdv;
         switch (op) {
-        case 0x01:                      // DW_LNS_copy
-            append();                   // emit
-            break;                      //
-        case 0x02:                      // DW_LNS_advance_pc
-            addr += data.uleb();        // advance
-            break;                      //
-        case 0x03:                      // DW_LNS_advance_line
-            line += data.sleb();        // advance (or go back)
-            break;                      //
-        case 0x04:                      // DW_LNS_set_file
-            fileIndex = data.uleb();    // set to uleb file index
-            break;                      //
-        case 0x05:                      // DW_LNS_set_column
-            col = data.uleb();          // set new val
-            break;                      //
-        case 0x08:                      // DW_LNS_const_add_pc
-            adjOp = 255 - opcodeBase;   // incr addr (but not line), as
-            opAdv = adjOp / lineRange;  // if special opcode 255 (p163),
-            addr += opAdv;              // assuming maxInsnOps == 1 (asserted above)
-            break;                      //
-        case 0x09:                      // DW_LNS_fixed_advance_pc
-            addr += data.u16();         // unencoded "uhalf"
-            break;                      //
-        case 0x06:                      // DW_LNS_negate_stmt
-        case 0x07:                      // DW_LNS_set_basic_block
-        case 0x0a:                      // DW_LNS_set_prologue_end
-        case 0x0b:                      // DW_LNS_set_epilogue_begin
-        case 0x0c:                      // DW_LNS_set_isa
-            break;                      //
-        default: err << "doStandard op=" << unsigned(op); throw std::runtime_error(err.str());
+        case 0x01:                                                // DW_LNS_copy
+            append();                                             // emit
+            break;                                                //
+        case 0x02:                                                // DW_LNS_advance_pc
+            addr += data.uleb() * minInstLength;                  // advance
+            break;                                                //
+        case 0x03:                                                // DW_LNS_advance_line
+            line += data.sleb();                                  // advance (or go back)
+            break;                                                //
+        case 0x04:                                                // DW_LNS_set_file
+            fileIndex = data.uleb();                              // set to uleb file index
+            break;                                                //
+        case 0x05:                                                // DW_LNS_set_column
+            col = data.uleb();                                    // set new val
+            break;                                                //
+        case 0x08:                                                // DW_LNS_const_add_pc
+            addr += ((255 - opcodeBase) / lineRange) * minInstLength;  // as if special op 255
+            break;                                                //
+        case 0x09:                                                // DW_LNS_fixed_advance_pc
+            addr += data.u16();                                   // unencoded "uhalf"
+            break;                                                //
+        default:                                                  // no-ops for us, or unknown:
+            for (size_t i = 0; i < opSizes[op]; i++) { data.uleb(); }  // skip any args
         }
     };
 
     auto doExtended = [&]() {
-        auto opSize = u8();
-        auto eop = u8();
-        // std::printf("op %02x extended\n", eop);
+        auto opSize = data.uleb();
+        auto const next = data + opSize;
+        auto eop = data.u8();
         switch (eop) {
-        case 0x01:              // DW_LNE_end_sequence
-            line = 0;           // sentinel marker
-            col = 0;            //
-            fileIndex = -1;     //
-            append();           // send out last record
-            reset();            // back to the initial state
-            break;              //
-        case 0x02:              // DW_LNE_set_address
-            addr = data.u64();  // read 64bit addr
-            break;              //
-        case 0x03:              // DW_LNE_set_discriminator
-            data.uleb();        // ignore
-            break;              //
-        default: {
-            err << "doExtended op=" << unsigned(eop);
-            throw std::runtime_error(err.str());
-        }
+        case 0x01:                                        // DW_LNE_end_sequence
+            out->addEnd(addr);                            // send out last record
+            reset();                                      // back to the initial state
+            break;                                        //
+        case 0x02:                                        // DW_LNE_set_address
+            addr = DWARFForm::sized(data, opSize - 1);    // operand is an address
+            break;                                        //
         }
+        data = next;  // skip any operands we didn't read (or unknown ops entirely)
     };
 
     auto doSpecial = [&](uint8_t op) {
-        // std::printf("op %02x special\n", op);
         // https://dwarfstd.org/doc/DWARF5.pdf (p161)
         auto adjOp = op - opcodeBase;
         auto opAdv = adjOp / lineRange;
-        auto lineAdv = lineBase + (adjOp % lineRange);
-        addr += opAdv;  // assuming maxInsnOps == 1 (asserted above)
+        auto lineAdv = lineBase + int(adjOp % lineRange);
+        addr += opAdv * minInstLength;
         line += lineAdv;
         append();
     };
 
-    auto doNextOp = [&]() {
-        err.clear();
-        auto op = u8();
-        if (op == 0) { return doExtended(); }
-        if (op < opcodeBase) { return doStandard(op); }
-        return doSpecial(op);
-    };
+    while (data < dataLimit) {
+        auto op = data.u8();
+        if (op == 0) {
+            doExtended();
+        } else if (op < opcodeBase) {
+            doStandard(op);
+        } else {
+            doSpecial(op);
+        }
+    }
+}
 
-    while (data < dataLimit) { doNextOp(); }
+/*
+    `.debug_aranges` unit: unit_length, version (2), debug_info_offset (offset size),
+    address_size (1), seg_size (1), padding to a multiple of 2 * address_size (from unit start),
+    then (address, length) pairs, ending with (0, 0).
+*/
+std::vector<DWARF::ARange> DWARF::aranges() const {
+    std::vector<ARange> ret;
+    if (!aranges_) { return ret; }
+    auto const data = aranges_->contents();
+    uint64_t offset = 0;
+    while (offset + 4 <= data.size_) {
+        auto cur = data + offset;
+        auto hdr = UnitHeader::read(cur, offset);
+        DWARFForm form {.version = hdr.version, .addrSize = 8, .offsetSize = hdr.offsetSize};
+        auto unit = form.offset(cur);
+        form.addrSize = cur.u8();
+        auto segSize = cur.u8();
+        if (segSize || (form.addrSize != 4 && form.addrSize != 8)) { break; }  // unsupported
+        size_t tuple = 2 * form.addrSize;
+        auto pos = cur.base_ + cur.offset_ - (data.base_ + offset);
+        cur += (tuple - pos % tuple) % tuple;
+        while (cur < data + hdr.end) {
+            auto begin = form.address(cur);
+            auto length = form.address(cur);
+            if (!begin && !length) { break; }
+            ret.push_back({begin, begin + length, unit});
+        }
+        offset = hdr.end;
+    }
+    std::ranges::sort(ret, {}, &ARange::begin);
+    return ret;
+}
 
-    fileIndex = -1;
-    line = 0;
-    col = 0;
-    append();
+/*
+    Compile unit header (in `.debug_info`):
+    v2-4: unit_length, version, debug_abbrev_offset, address_size
+    v5:   unit_length, version, unit_type, address_size, debug_abbrev_offset, [more by type]
+    then the first DIE, which for a compile unit is the DW_TAG_compile_unit.
+*/
+std::optional<uint64_t> DWARF::lineUnitOf(uint64_t unit) const {
+    constexpr static uint64_t kStmtList = 0x10;  // DW_AT_stmt_list
+    if (!info_ || !abbrev_) { return std::nullopt; }
+
+    auto cur = info_->contents() + unit;
+    auto hdr = UnitHeader::read(cur, unit);
+    DWARFForm form {.version = hdr.version, .addrSize = 8, .offsetSize = hdr.offsetSize};
+    uint64_t abbrevOffset;
+    if (hdr.version >= 5) {
+        auto unitType = cur.u8();
+        form.addrSize = cur.u8();
+        abbrevOffset = form.offset(cur);
+        if (unitType == 0x04 || unitType == 0x05) { cur += 8; }  // skeleton/split: dwo_id
+        if (unitType == 0x02 || unitType == 0x06) { return std::nullopt; }  // type units
+    } else {
+        abbrevOffset = form.offset(cur);
+        form.addrSize = cur.u8();
+    }
+    auto code = cur.uleb();
+
+    // Find that abbreviation: (code, tag, has_children, then (attr, form) pairs until (0, 0))
+    auto abbrev = abbrev_->contents() + abbrevOffset;
+    while (true) {
+        auto thisCode = abbrev.uleb();
+        if (!thisCode) { return std::nullopt; }
+        abbrev.uleb();  // tag
+        abbrev.u8();    // has_children
+        bool found = (thisCode == code);
+        while (true) {
+            auto attr = abbrev.uleb();
+            auto attrForm = uint16_t(abbrev.uleb());
+            if (!attr && !attrForm) { break; }
+            if (attrForm == DWARFForm::IMPLICIT_CONST) {
+                auto val = abbrev.sleb();
+                if (found && attr == kStmtList) { return uint64_t(val); }
+                continue;
+            }
+            if (!found) { continue; }
+            if (attr == kStmtList) { return form.unsignedValue(cur, attrForm); }
+            form.skip(cur, attrForm);
+        }
+        if (found) { return std::nullopt; }
+    }
 }
 
 }  // namespace cxx
@@ -0,0 +1,162 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "../io/Cursor.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace cxx {
+
+/**
+ * Reads attribute values encoded in any `DW_FORM_*` (DWARF 2 through 5, plus some GNU
+ * extensions), given the encoding parameters of the unit they appear in.
+ * https://dwarfstd.org/doc/DWARF5.pdf (section 7.5.6)
+ */
+struct DWARFForm final {
+    // clang-format off
+    enum : uint16_t {
+        ADDR = 0x01, BLOCK2 = 0x03, BLOCK4 = 0x04, DATA2 = 0x05, DATA4 = 0x06, DATA8 = 0x07,
+        STRING = 0x08, BLOCK = 0x09, BLOCK1 = 0x0a, DATA1 = 0x0b, FLAG = 0x0c, SDATA = 0x0d,
+        STRP = 0x0e, UDATA = 0x0f, REF_ADDR = 0x10, REF1 = 0x11, REF2 = 0x12, REF4 = 0x13,
+        REF8 = 0x14, REF_UDATA = 0x15, INDIRECT = 0x16, SEC_OFFSET = 0x17, EXPRLOC = 0x18,
+        FLAG_PRESENT = 0x19, STRX = 0x1a, ADDRX = 0x1b, REF_SUP4 = 0x1c, STRP_SUP = 0x1d,
+        DATA16 = 0x1e, LINE_STRP = 0x1f, REF_SIG8 = 0x20, IMPLICIT_CONST = 0x21,
+        LOCLISTX = 0x22, RNGLISTX = 0x23, REF_SUP8 = 0x24, STRX1 = 0x25, STRX2 = 0x26,
+        STRX3 = 0x27, STRX4 = 0x28, ADDRX1 = 0x29, ADDRX2 = 0x2a, ADDRX3 = 0x2b, ADDRX4 = 0x2c,
+        GNU_ADDR_INDEX = 0x1f01, GNU_STR_INDEX = 0x1f02, GNU_REF_ALT = 0x1f20,
+        GNU_STRP_ALT = 0x1f21,
+    };
+    // clang-format on
+
+    uint16_t version {5};
+    uint8_t addrSize {8};
+    uint8_t offsetSize {4};  // 8 for DWARF64
+
+    static uint64_t sized(Cursor& cur, size_t size) {
+        switch (size) {
+        case 1: return cur.u8();
+        case 2: return cur.u16();
+        case 3: {
+            uint64_t lo = cur.u16();
+            return lo | (uint64_t(cur.u8()) << 16);
+        }
+        case 4: return cur.u32();
+        case 8: return cur.u64();
+        }
+        throw std::runtime_error("unsupported DWARF value size");
+    }
+
+    uint64_t offset(Cursor& cur) const { return sized(cur, offsetSize); }
+    uint64_t address(Cursor& cur) const { return sized(cur, addrSize); }
+
+    /** Size in bytes of a value of fixed-size `form`, or nullopt if variable (or unknown). */
+    std::optional<size_t> fixedSize(uint16_t form) const {
+        switch (form) {
+        case FLAG_PRESENT:
+        case IMPLICIT_CONST: return 0;
+        case DATA1:
+        case REF1:
+        case FLAG:
+        case STRX1:
+        case ADDRX1:         return 1;
+        case DATA2:
+        case REF2:
+        case STRX2:
+        case ADDRX2:         return 2;
+        case STRX3:
+        case ADDRX3:         return 3;
+        case DATA4:
+        case REF4:
+        case REF_SUP4:
+        case STRX4:
+        case ADDRX4:         return 4;
+        case DATA8:
+        case REF8:
+        case REF_SIG8:
+        case REF_SUP8:       return 8;
+        case DATA16:         return 16;
+        case ADDR:           return addrSize;
+        case REF_ADDR:       return version <= 2 ? addrSize : offsetSize;
+        case STRP:
+        case LINE_STRP:
+        case SEC_OFFSET:
+        case STRP_SUP:
+        case GNU_REF_ALT:
+        case GNU_STRP_ALT:   return offsetSize;
+        default:             return std::nullopt;
+        }
+    }
+
+    /** Move past a value of `form`. */
+    void skip(Cursor& cur, uint16_t form) const {
+        if (auto size = fixedSize(form)) { return (void) (cur += *size); }
+        switch (form) {
+        case STRING:
+            while (cur.u8()) {}
+            return;
+        case SDATA:          cur.sleb(); return;
+        case UDATA:
+        case REF_UDATA:
+        case STRX:
+        case ADDRX:
+        case LOCLISTX:
+        case RNGLISTX:
+        case GNU_ADDR_INDEX:
+        case GNU_STR_INDEX:  cur.uleb(); return;
+        case BLOCK1:         cur += cur.u8(); return;
+        case BLOCK2:         cur += cur.u16(); return;
+        case BLOCK4:         cur += cur.u32(); return;
+        case BLOCK:
+        case EXPRLOC:        cur += cur.uleb(); return;
+        case INDIRECT:       return skip(cur, uint16_t(cur.uleb()));
+        }
+        throw std::runtime_error("unknown DWARF form " + std::to_string(form));
+    }
+
+    /** Read an integer-like value (constant, offset, reference, index, flag). */
+    uint64_t unsignedValue(Cursor& cur, uint16_t form) const {
+        switch (form) {
+        case SDATA:          return uint64_t(cur.sleb());
+        case UDATA:
+        case REF_UDATA:
+        case STRX:
+        case ADDRX:
+        case LOCLISTX:
+        case RNGLISTX:
+        case GNU_ADDR_INDEX:
+        case GNU_STR_INDEX:  return cur.uleb();
+        case INDIRECT:       return unsignedValue(cur, uint16_t(cur.uleb()));
+        case FLAG_PRESENT:   return 1;
+        }
+        auto size = fixedSize(form);
+        if (!size || *size > 8) { throw std::runtime_error("not an integer DWARF form"); }
+        return *size ? sized(cur, *size) : 0;
+    }
+
+    /**
+     * Read a string.  `str` and `lineStr` are the contents of `.debug_str` and `.debug_line_str`
+     * (either may be absent, if the form doesn't refer to it).  Indexed strings (`strx`) can't be
+     * resolved from here and come back empty.
+     */
+    std::string stringValue(Cursor& cur, uint16_t form, Cursor const* str, Cursor const* lineStr)
+            const {
+        switch (form) {
+        case STRING: return cur.str();
+        case STRP:
+            if (!str) { throw std::runtime_error("DW_FORM_strp without .debug_str"); }
+            return (*str + offset(cur)).str();
+        case LINE_STRP:
+            if (!lineStr) { throw std::runtime_error("DW_FORM_line_strp without .debug_line_str"); }
+            return (*lineStr + offset(cur)).str();
+        }
+        skip(cur, form);
+        return {};
+    }
+};
+
+}  // namespace cxx
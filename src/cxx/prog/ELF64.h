@@ -0,0 +1,378 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "../io/ByteBuffer.h"
+#include "../io/Bytes.h"
+#include "../io/Cursor.h"
+#include "../io/File.h"
+#include "../io/Inflate.h"
+#include "ObjectFile.h"
+#include "SourceLoc.h"
+#include "SymbolTable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace cxx {
+
+struct ElfBinary64;
+
+struct ElfSection64 final : Section {
+    constexpr static size_t kSectionHeaderSize = 64;
+    constexpr static uint32_t kSymTab = 2;   // SHT_SYMTAB: full symbol table (`.symtab`)
+    constexpr static uint32_t kNote = 7;     // SHT_NOTE: vendor notes, e.g. the build ID
+    constexpr static uint32_t kNoBits = 8;   // SHT_NOBITS: occupies no space in the file (.bss)
+    constexpr static uint32_t kDynSym = 11;  // SHT_DYNSYM: exported symbols (`.dynsym`)
+    constexpr static uint64_t kCompressed = 0x800;  // SHF_COMPRESSED flag
+
+    ElfBinary64 const* binary_;
+    size_t const index_;
+    Cursor const base_;
+
+    ElfSection64(ElfBinary64 const* binary, size_t index);
+
+    Cursor cur() const override { return base_; }
+    std::string name() const override;
+    Binary const* binary() const override;
+
+    /** The section's data; if compressed (see `compressed`), inflated, on first use. */
+    Cursor contents() const override;
+
+    /** The section's bytes in the file, compressed or not. */
+    Cursor rawContents() const;
+
+    /** Whether compressed: with SHF_COMPRESSED, or the older GNU way, as `.zdebug_*`. */
+    bool compressed() const;
+
+    /** The name, within the names section's contents; empty if not in there. */
+    std::string_view nameView() const;
+
+    uint32_t type() const { return (cur() + 4).u32(); }
+    uint64_t flags() const { return (cur() + 8).u64(); }
+    uint64_t offset() const { return (cur() + 24).u64(); }
+    uint64_t size() const { return (cur() + 32).u64(); }
+    uint32_t link() const { return (cur() + 40).u32(); }
+};
+
+struct ElfBinary64 final : Binary {
+    constexpr static uint32_t kMagic = 0x464c457f;  // "\x7f" "ELF", read as little-endian u32
+
+    ElfBinary64(Ref<File> file, uintptr_t vmaSlide);
+    Cursor cur() const override;
+
+    std::vector<Ref<Section>> sections() const override;
+    uint64_t slideAt(uintptr_t loadBase) const override;
+    void readSymbols(SymbolTable* out) const override;
+    std::string buildID() const override;
+    std::optional<DebugLink> debugLink() const override;
+
+    /** Lowest virtual address of any loadable segment; where the file expects to be mapped. */
+    uint64_t loadAddress() const;
+
+    size_t sectionCount_ {0};  // including the null section 0
+    size_t nameSection_ {0};   // index of section names section (`.shstrtab`)
+
+    Cursor sectionHeader(size_t index) const;
+
+    /** A compressed section's contents, inflated (once) into memory kept by this binary. */
+    Cursor inflated(ElfSection64 const& section) const;
+
+private:
+    struct Inflated final {
+        std::once_flag once;
+        Ref<ByteBuffer> bytes;  // empty if it couldn't be inflated
+    };
+    std::unique_ptr<Inflated[]> inflated_;  // by section index
+};
+
+/*
+    ELF64 header (64 bytes):
+    https://refspecs.linuxfoundation.org/elf/gabi4+/ch4.eheader.html
+    +0                   +4                   +8                   +12
+    | 0x7f 'E' 'L' 'F'   | class, data, ver.. | (@ 8) padding                           |
+    | (@ 16) type, mach  | (@ 20) version     | (@ 24) entry                            |
+    | (@ 32) phoff                            | (@ 40) shoff                            |
+    | (@ 48) flags       | ehsize, phentsize  | (@ 56) phnum,shent | (@ 60) shnum,shstr |
+
+    Only 64-bit little-endian files are handled (class 2, data 1).
+    If there are too many sections to fit `shnum`, or the `shstrndx` index of the section
+    names section doesn't fit in its field, the real values are in section 0's header.
+
+    Files are often truncated or corrupt (e.g. a half-written debug file), and are read from
+    a crashing process's stack traces, so nothing here trusts them: section headers must be
+    within the file (else it's taken to have none), as must sections' contents (else empty).
+*/
+ElfBinary64::ElfBinary64(Ref<File> file, uintptr_t vmaSlide) : Binary(file, vmaSlide) {
+    auto hdr = cur();
+    auto const size = hdr.size_;
+    if (size < 64 || hdr.peekU8(4) != 2 || hdr.peekU8(5) != 1) { return; }  // not ELF64 LE
+    auto shoff = (hdr + 40).u64();
+    auto shentsize = (hdr + 58).u16();
+    uint64_t count = (hdr + 60).u16();
+    uint64_t names = (hdr + 62).u16();
+    if (!shoff || shentsize != ElfSection64::kSectionHeaderSize || shoff > size ||
+        size - shoff < ElfSection64::kSectionHeaderSize) {
+        return;  // no (readable) sections
+    }
+    if (!count) { count = (sectionHeader(0) + 32).u64(); }
+    if (names == 0xffff) { names = (sectionHeader(0) + 40).u32(); }
+    if (count > (size - shoff) / ElfSection64::kSectionHeaderSize) { return; }
+    sectionCount_ = count;
+    nameSection_ = (names < count) ? names : 0;  // section 0 has no contents, so no names
+    inflated_.reset(new Inflated[sectionCount_]);
+}
+
+Cursor ElfBinary64::cur() const { return this->file_->cur(); }
+
+Cursor ElfBinary64::sectionHeader(size_t index) const {
+    auto hdr = cur();
+    auto shoff = (hdr + 40).u64();
+    auto shentsize = (hdr + 58).u16();
+    return hdr + (shoff + index * shentsize);
+}
+
+std::vector<Ref<Section>> ElfBinary64::sections() const {
+    std::vector<Ref<Section>> ret;
+    // Section 0 is always the null section
+    for (size_t i = 1; i < sectionCount_; i++) {
+        ret.emplace_back(Ref<ElfSection64>::make(this, i));
+    }
+    return ret;
+}
+
+/*
+    Program header (56 bytes):
+    +0                   +4                   +8                   +12
+    | (@ 0) type         | (@ 4) flags        | (@ 8) offset                            |
+    | (@ 16) vaddr                            | (@ 24) paddr                            |
+    | (@ 32) filesz                           | (@ 40) memsz                            |
+    | (@ 48) align                            |
+*/
+uint64_t ElfBinary64::loadAddress() const {
+    constexpr static uint32_t kLoad = 1;  // PT_LOAD
+    auto hdr = cur();
+    if (hdr.size_ < 64) { return 0; }
+    auto phoff = (hdr + 32).u64();
+    auto phentsize = (hdr + 54).u16();
+    auto phnum = (hdr + 56).u16();
+    if (phentsize < 56 || phoff > hdr.size_ || phnum > (hdr.size_ - phoff) / phentsize) {
+        return 0;  // headers not all in the file
+    }
+    uint64_t ret = UINT64_MAX;
+    for (size_t i = 0; i < phnum; i++) {
+        auto ph = hdr + (phoff + i * phentsize);
+        if (ph.peekU32() != kLoad) { continue; }
+        auto vaddr = (ph + 16).u64();
+        auto align = (ph + 48).u64();
+        if (align > 1) { vaddr &= ~(align - 1); }
+        if (vaddr < ret) { ret = vaddr; }
+    }
+    return (ret == UINT64_MAX) ? 0 : ret;
+}
+
+uint64_t ElfBinary64::slideAt(uintptr_t loadBase) const {
+    return loadBase ? loadBase - loadAddress() : vmaSlide_;
+}
+
+/*
+    Symbol table entry (24 bytes), in a section of type SHT_SYMTAB or SHT_DYNSYM:
+    +0                   +4                   +8                   +12
+    | (@ 0) name         | info,other,shndx   | (@ 8) value                             |
+    | (@ 16) size                             |
+
+    `name` is an offset into the string table section given by the symbol section's `link`.
+    The low 4 bits of `info` are the type; `shndx` 0 means undefined (imported from elsewhere).
+    A stripped binary may have only `.dynsym`; then non-exported functions won't be found.
+*/
+void ElfBinary64::readSymbols(SymbolTable* out) const {
+    constexpr static uint8_t kFunc = 2;    // STT_FUNC
+    constexpr static uint8_t kIFunc = 10;  // STT_GNU_IFUNC
+    constexpr static size_t kSymSize = 24;
+
+    for (size_t i = 1; i < sectionCount_; i++) {
+        ElfSection64 section(this, i);
+        if (section.type() != ElfSection64::kSymTab && section.type() != ElfSection64::kDynSym) {
+            continue;
+        }
+        if (section.link() >= sectionCount_) { continue; }
+        auto const names = ElfSection64(this, section.link()).contents();
+        if (!names.size_ || names.peekU8(names.size_ - 1)) { continue; }  // last unterminated
+        auto const syms = section.contents();
+        for (size_t offset = 0; offset + kSymSize <= syms.size_; offset += kSymSize) {
+            auto sym = syms + offset;
+            auto name = sym.u32();
+            auto type = sym.u8() & 0x0f;
+            sym.u8();  // other
+            auto shndx = sym.u16();
+            auto value = sym.u64();
+            auto size = sym.u64();
+            if ((type != kFunc && type != kIFunc) || !shndx || name >= names.size_) { continue; }
+            out->add(value, size, (char const*) (names.base_ + names.offset_ + name));
+        }
+    }
+}
+
+/*
+    Notes, in sections of type SHT_NOTE; each 4-byte aligned:
+    +0                   +4                   +8                   +12
+    | (@ 0) namesz       | (@ 4) descsz       | (@ 8) type         | name, desc ...
+    The name and desc are each padded to a multiple of 4 bytes.  The build ID is the desc of the
+    note named "GNU" with type 3 (NT_GNU_BUILD_ID); the linker makes it from (a hash of) the
+    file's contents, and copies it into any separate debug info file.
+*/
+std::string ElfBinary64::buildID() const {
+    constexpr static uint32_t kBuildID = 3;  // NT_GNU_BUILD_ID
+    constexpr static char const* kHex = "0123456789abcdef";
+    auto pad = [](uint64_t size) { return (size + 3) & ~uint64_t(3); };
+
+    for (size_t i = 1; i < sectionCount_; i++) {
+        ElfSection64 section(this, i);
+        if (section.type() != ElfSection64::kNote) { continue; }
+        auto const notes = section.contents();
+        uint64_t offset = 0;
+        while (offset + 12 <= notes.size_) {
+            auto note = notes + offset;
+            auto nameSize = note.u32();
+            auto descSize = note.u32();
+            auto type = note.u32();
+            auto desc = offset + 12 + pad(nameSize);
+            if (desc + descSize > notes.size_) { break; }
+            if (type == kBuildID && nameSize == 4 && note.str() == "GNU") {
+                std::string ret;
+                for (uint64_t j = 0; j < descSize; j++) {
+                    auto byte = notes.peekU8(desc + j);
+                    ret += kHex[byte >> 4];
+                    ret += kHex[byte & 15];
+                }
+                return ret;
+            }
+            offset = desc + pad(descSize);
+        }
+    }
+    return {};
+}
+
+/*
+    `.gnu_debuglink` section: the debug file's name (NUL-terminated, padded to a multiple of 4
+    bytes) then the CRC-32 of that file's whole contents (4 bytes).
+*/
+std::optional<DebugLink> ElfBinary64::debugLink() const {
+    for (size_t i = 1; i < sectionCount_; i++) {
+        ElfSection64 section(this, i);
+        if (section.name() != ".gnu_debuglink") { continue; }
+        auto const data = section.contents();
+        if (data.size_ < 8) { return std::nullopt; }
+        auto file = Cursor(data).fixedStr(unsigned(data.size_ - 4));
+        auto crcOffset = (file.size() + 4) & ~size_t(3);  // past the NUL, then padded
+        if (file.empty() || crcOffset + 4 > data.size_) { return std::nullopt; }
+        return DebugLink {file, data.peekU32(crcOffset)};
+    }
+    return std::nullopt;
+}
+
+/*
+    Section header (64 bytes):
+    +0                   +4                   +8                   +12
+    | (@ 0) name         | (@ 4) type         | (@ 8) flags                             |
+    | (@ 16) addr                             | (@ 24) offset                           |
+    | (@ 32) size                             | (@ 40) link        | (@ 44) info        |
+    | (@ 48) addralign                        | (@ 56) entsize                          |
+
+    `name` is an offset into the section names section (usually `.shstrtab`).
+*/
+
+ElfSection64::ElfSection64(ElfBinary64 const* binary, size_t index)
+        : binary_(binary)
+        , index_(index)
+        , base_(binary->sectionHeader(index)) {}
+
+std::string ElfSection64::name() const { return std::string(nameView()); }
+
+std::string_view ElfSection64::nameView() const {
+    auto names = ElfSection64(binary_, binary_->nameSection_).rawContents();
+    auto offset = cur().peekU32();
+    if (offset >= names.size_) { return {}; }
+    auto const* str = (char const*) names.base_ + offset;
+    return {str, ::strnlen(str, names.size_ - offset)};
+}
+
+Binary const* ElfSection64::binary() const { return binary_; }
+
+Cursor ElfSection64::rawContents() const {
+    auto file = binary()->cur();
+    auto offset = this->offset();
+    auto size = this->size();
+    if (type() == kNoBits || offset > file.size_ || size > file.size_ - offset) {
+        return {file.owner_, file.base_, 0};  // none, or not (all) in the file
+    }
+    return {file.owner_, file.base_ + offset, size};
+}
+
+Cursor ElfSection64::contents() const {
+    return compressed() ? binary_->inflated(*this) : rawContents();
+}
+
+bool ElfSection64::compressed() const {
+    if (type() == kNoBits) { return false; }
+    if (flags() & kCompressed) { return true; }
+    return nameView().starts_with(".zdebug");
+}
+
+/*
+    Compressed sections (as from `-gz`): with the SHF_COMPRESSED flag, a header (24 bytes):
+    +0                   +4                   +8                   +12
+    | (@ 0) type         | (@ 4) reserved     | (@ 8) size, inflated                    |
+    | (@ 16) addralign                        |
+    then the compressed data.  Type 1 is zlib; type 2, zstd, isn't supported here.
+    Older, GNU-style `.zdebug_*` sections have "ZLIB", the inflated size (big-endian u64), and
+    the zlib data.  The inflated data of each are kept (with the binary) as long as it's open.
+*/
+Cursor ElfBinary64::inflated(ElfSection64 const& section) const {
+    constexpr static uint32_t kZlib = 1;  // ELFCOMPRESS_ZLIB
+
+    auto& entry = inflated_[section.index_];
+    std::call_once(entry.once, [&] {
+        auto raw = section.rawContents();
+        try {
+            uint64_t size = 0;
+            size_t header = 0;
+            if (section.flags() & ElfSection64::kCompressed) {
+                if (raw.size_ < 24) { throw std::runtime_error("truncated header"); }
+                auto type = raw.peekU32(0);
+                if (type != kZlib) {
+                    throw std::runtime_error("unsupported type " + std::to_string(type));
+                }
+                size = raw.peekU64(8);
+                header = 24;
+            } else {
+                if (raw.size_ < 12 || std::memcmp(raw.base_, "ZLIB", 4)) {
+                    throw std::runtime_error("bad header");
+                }
+                for (size_t i = 4; i < 12; i++) { size = size << 8 | raw.peekU8(i); }
+                header = 12;
+            }
+            auto bytes = Ref<ByteBuffer>::make(size);
+            inflateZlib(raw.base_ + header, raw.size_ - header, bytes->data_, size);
+            entry.bytes = std::move(bytes);
+        } catch (std::exception const& e) {
+            std::cerr << "cannot inflate section " << section.name() << ": " << e.what()
+                      << std::endl;
+        }
+    });
+    if (!entry.bytes) { return {this, cur().base_, 0}; }
+    return entry.bytes->cur();
+}
+
+}  // namespace cxx
@@ -0,0 +1,271 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "DIE.h"
+#include "DWARF.h"
+#include "ObjectFile.h"
+#include "SplitDWARF.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cxx {
+
+/**
+ * Maps addresses to the functions containing them, from `.debug_info`: each `DW_TAG_subprogram`
+ * with code, and within it, the `DW_TAG_inlined_subroutine`s (nested, perhaps several deep)
+ * showing which calls were inlined there, and from where.
+ *
+ * Only the compile units' top-level entries are read up front, for their address ranges; a
+ * unit's tree of entries is read (once, by one thread) the first time a lookup lands in it.
+ * With split DWARF, that tree is read from the unit's `.dwo` (or the `.dwp`); see `SplitDWARF`.
+ */
+class FunctionIndex final {
+public:
+    /**
+     * One function in the chain at some address.  `callFile:callLine` is where this function
+     * was inlined into the next (outer) one in the chain; unset for the outermost.
+     */
+    struct Scope final {
+        char const* name;  // linkage (mangled) name where known, else the plain name
+        char const* callFile;
+        uint32_t callLine;
+        uint32_t callCol;
+    };
+
+    /** A call inlined into some function, and where it is; see `forEachFunction`. */
+    struct InlinedCall final {
+        uint64_t begin;
+        uint64_t end;
+        uint32_t depth;  // how many other inlined calls it's (lexically) within
+        Scope scope;
+    };
+
+private:
+    struct Function final {
+        std::string name;
+        uint32_t firstInline;  // this function's entries in `Unit::inlines`
+        uint32_t inlineCount;
+    };
+
+    struct Inline final {
+        uint64_t begin;
+        uint64_t end;
+        uint32_t func;   // which `Function` it's in
+        uint32_t depth;  // how many other inlined calls it's (lexically) within
+        std::string name;
+        uint32_t callFile;
+        uint32_t callLine;
+        uint32_t callCol;
+    };
+
+    /** Addresses `[begin, end)` are in `index` (a unit, or a function in a unit). */
+    struct Range final {
+        uint64_t begin;
+        uint64_t end;
+        size_t index;
+    };
+
+    struct Unit final {
+        uint64_t offset;  // within `.debug_info`
+        std::once_flag once;
+        std::vector<std::string> files;  // from the unit's line program, for `call_file`
+        std::vector<Function> functions;
+        std::vector<Inline> inlines;  // grouped by function
+        std::vector<Range> ranges;    // of functions; sorted by `begin`
+    };
+
+    DWARF dwarf_;
+    std::vector<std::unique_ptr<Unit>> units_;  // sorted by offset
+    std::vector<Range> unitRanges_;             // sorted by `begin`
+    SplitDWARF mutable split_;
+
+    /** Last range in `ranges` (sorted by `begin`) starting at or before `addr`, if it has it. */
+    static Range const* findRange(std::vector<Range> const& ranges, uint64_t addr) {
+        auto it = std::ranges::upper_bound(ranges, addr, {}, &Range::begin);
+        if (it == ranges.begin() || addr >= (--it)->end) { return nullptr; }
+        return &*it;
+    }
+
+    /** Name of the function described by `die`, following references to other entries. */
+    std::string nameOf(DIEReader const& reader, DIE const& die, int hops = 0) const {
+        if (die.linkageName) { return reader.string(*die.linkageName); }
+        auto const& target = die.origin ? die.origin : die.specification;
+        if (target && hops < 4) {
+            if (auto ref = reader.ref(*target)) {
+                std::string ret;
+                if (reader.contains(*ref)) {
+                    ret = nameOf(reader, reader.at(*ref), hops + 1);
+                } else if (&reader.dwarf_ == &dwarf_) {
+                    // In some other unit; e.g. after LTO
+                    auto it = std::ranges::upper_bound(units_, *ref, {}, &Unit::offset);
+                    if (it != units_.begin()) {
+                        DIEReader other(dwarf_, (*--it)->offset);
+                        if (other.contains(*ref)) { ret = nameOf(other, other.at(*ref), hops + 1); }
+                    }
+                }
+                if (!ret.empty()) { return ret; }
+            }
+        }
+        return die.name ? reader.string(*die.name) : "";
+    }
+
+    void decode(Unit& unit) const {
+        DIEReader reader(dwarf_, unit.offset);
+        if (!reader.skeleton()) { return decode(unit, reader); }
+        if (auto split = split_.find(reader)) {
+            DIEReader splitReader(split->dwarf, split->offset, &reader);
+            decode(unit, splitReader);
+        }
+    }
+
+    void decode(Unit& unit, DIEReader const& reader) const {
+        if (!reader.compileUnit_ || !reader.top_.children) { return; }
+        // A split unit's file names are in the (file names only) line table of its own file
+        auto const& dwarf = reader.dwarf_;
+        if (reader.top_.stmtList) {
+            unit.files = dwarf.lineFiles(reader.top_.stmtList->raw);
+        } else if (&dwarf != &dwarf_) {
+            unit.files = dwarf.lineFiles(0);
+        }
+
+        // Enclosing function (if any) and inlining depth, for each level of the tree
+        struct Level final {
+            int64_t func;
+            uint32_t depth;
+        };
+        std::vector<Level> levels {{-1, 0}};
+        auto cur = reader.first_;
+        DIE die;
+        while (!levels.empty() && reader.pos(cur) < reader.end()) {
+            reader.next(cur, &die);
+            if (!die.tag) {
+                levels.pop_back();
+                continue;
+            }
+            auto level = levels.back();
+            if (die.tag == DIE::SUBPROGRAM) {
+                auto func = uint32_t(unit.functions.size());
+                reader.ranges(die, [&](uint64_t begin, uint64_t end) {
+                    if (unit.functions.size() == func) {
+                        unit.functions.push_back({nameOf(reader, die), 0, 0});
+                    }
+                    unit.ranges.push_back({begin, end, func});
+                });
+                if (unit.functions.size() > func) { level = {func, 0}; }
+            } else if (die.tag == DIE::INLINED_SUBROUTINE && level.func >= 0) {
+                auto name = nameOf(reader, die);
+                auto value = [](auto const& val) { return val ? uint32_t(val->raw) : 0; };
+                reader.ranges(die, [&](uint64_t begin, uint64_t end) {
+                    unit.inlines.push_back({begin, end, uint32_t(level.func), level.depth, name,
+                                            value(die.callFile), value(die.callLine),
+                                            value(die.callCol)});
+                });
+                ++level.depth;
+            }
+            if (die.children) { levels.push_back(level); }
+        }
+
+        std::ranges::stable_sort(unit.inlines, {}, &Inline::func);
+        for (size_t i = unit.inlines.size(); i-- > 0;) {
+            auto& func = unit.functions[unit.inlines[i].func];
+            func.firstInline = uint32_t(i);
+            ++func.inlineCount;
+        }
+        std::ranges::sort(unit.ranges, {}, &Range::begin);
+    }
+
+    static Scope scope(Unit const& unit, Inline const& in) {
+        auto const* file = in.callFile < unit.files.size() ? unit.files[in.callFile].c_str() : "";
+        return {in.name.c_str(), file, in.callLine, in.callCol};
+    }
+
+    Unit& unit(size_t index) const {
+        auto& unit = *units_[index];
+        std::call_once(unit.once, [&] {
+            try {
+                decode(unit);
+            } catch (std::exception const& e) {
+                std::cerr << "cannot decode DWARF: " << e.what() << std::endl;
+            }
+        });
+        return unit;
+    }
+
+public:
+    explicit FunctionIndex(Binary const* binary) : dwarf_(*binary), split_(binary, dwarf_) {
+        if (!dwarf_.info_ || !dwarf_.abbrev_) { return; }
+        for (auto offset : dwarf_.infoUnits()) {
+            units_.emplace_back(new Unit {.offset = offset});
+            try {
+                DIEReader reader(dwarf_, offset);
+                if (!reader.compileUnit_) { continue; }
+                reader.ranges(reader.top_, [&](uint64_t begin, uint64_t end) {
+                    unitRanges_.push_back({begin, end, units_.size() - 1});
+                });
+            } catch (std::exception const& e) {
+                std::cerr << "cannot decode DWARF: " << e.what() << std::endl;
+            }
+        }
+        std::ranges::sort(unitRanges_, {}, &Range::begin);
+    }
+
+    size_t unitCount() const { return units_.size(); }
+
+    /**
+     * Functions at (unslid) address `addr`, innermost first: any inlined calls, then the function
+     * they're all in.  Empty if not known.  The strings are valid for the life of this index.
+     */
+    std::vector<Scope> find(uint64_t addr) const {
+        std::vector<Scope> ret;
+        auto const* unitRange = findRange(unitRanges_, addr);
+        if (!unitRange) { return ret; }
+        auto const& u = unit(unitRange->index);
+        auto const* funcRange = findRange(u.ranges, addr);
+        if (!funcRange) { return ret; }
+        auto const& func = u.functions[funcRange->index];
+
+        std::vector<Inline const*> chain;
+        for (size_t i = func.firstInline; i < func.firstInline + func.inlineCount; i++) {
+            auto const& in = u.inlines[i];
+            if (addr >= in.begin && addr < in.end) { chain.push_back(&in); }
+        }
+        std::ranges::sort(chain, std::greater {}, &Inline::depth);
+
+        for (auto const* in : chain) { ret.push_back(scope(u, *in)); }
+        ret.push_back({func.name.c_str(), nullptr, 0, 0});
+        return ret;
+    }
+
+    /**
+     * Decode all units, and call `fn(begin, end, name, calls)` for each address range of each
+     * function, with `calls` (a vector of `InlinedCall`) those inlined into it in that range.
+     */
+    template <typename F>
+    void forEachFunction(F&& fn) const {
+        std::vector<InlinedCall> calls;
+        for (size_t i = 0; i < units_.size(); i++) {
+            auto const& u = unit(i);
+            for (auto const& range : u.ranges) {
+                auto const& func = u.functions[range.index];
+                calls.clear();
+                for (size_t j = func.firstInline; j < func.firstInline + func.inlineCount; j++) {
+                    auto const& in = u.inlines[j];
+                    if (in.end <= range.begin || in.begin >= range.end) { continue; }
+                    calls.push_back({in.begin, in.end, in.depth, scope(u, in)});
+                }
+                fn(range.begin, range.end, func.name, calls);
+            }
+        }
+    }
+};
+
+}  // namespace cxx
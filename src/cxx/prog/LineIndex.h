@@ -0,0 +1,200 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "../gen/parallelMap.h"
+#include "DIE.h"
+#include "DWARF.h"
+#include "LineTable.h"
+#include "ObjectFile.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace cxx {
+
+/**
+ * Address-to-line lookup over all the line program units of a binary.  Units are decoded
+ * lazily, each at most once (and by one thread only), when a lookup first needs them; a trace
+ * through a few functions then costs a few units' decoding, not the whole binary's.
+ *
+ * `.debug_aranges` says which compile unit (and so which line program) covers an address; for
+ * units it leaves out (it's optional, and clang doesn't emit it by default), each unit's own
+ * `DW_AT_low_pc` / `high_pc` / `ranges` say.  An address outside all of those (e.g. in a PLT
+ * stub, or startup code) has no line info, and is a miss without decoding anything.  Only if
+ * some unit's ranges can't be read are all units decoded (once) and searched.  To pay that cost
+ * up front instead (say, while a service starts), call `decodeAll`, which spreads the units
+ * across a pool of threads.
+ */
+class LineIndex final {
+public:
+    struct Hit final {
+        LineTable const* table {nullptr};
+        LineTable::Row const* row {nullptr};
+
+        explicit operator bool() const { return row; }
+    };
+
+private:
+    struct Unit final {
+        uint64_t offset;  // within `.debug_line`
+        std::once_flag once;
+        LineTable table;
+    };
+
+    /** Addresses `[begin, end)` are in `units_[unit]`. */
+    struct Range final {
+        uint64_t begin;
+        uint64_t end;
+        size_t unit;
+    };
+
+    DWARF dwarf_;
+    std::vector<std::unique_ptr<Unit>> units_;  // sorted by offset
+    std::vector<Range> ranges_;  // from `.debug_aranges` or compile units; sorted by `begin`
+    bool covered_ {true};        // false if some unit's ranges couldn't be read
+    std::once_flag allOnce_;
+    std::vector<Range> spans_;  // decoded units' extents, once all decoded; sorted by `begin`
+    std::vector<uint64_t> reach_;  // `reach_[i]`: largest `end` among `spans_[0..i]`
+
+    size_t unitAt(uint64_t offset) const {
+        auto it = std::ranges::lower_bound(units_, offset, {}, &Unit::offset);
+        return (it != units_.end() && (*it)->offset == offset) ? it - units_.begin() : SIZE_MAX;
+    }
+
+    LineTable const& table(size_t index) {
+        auto& unit = *units_[index];
+        std::call_once(unit.once, [&] {
+            try {
+                dwarf_.evalLineProg(&unit.table, unit.offset);
+            } catch (std::exception const& e) {
+                std::cerr << "cannot decode DWARF: " << e.what() << std::endl;
+            }
+            unit.table.finish();
+        });
+        return unit.table;
+    }
+
+    Hit findIn(size_t index, uint64_t addr) {
+        auto const& lines = table(index);
+        return {&lines, lines.find(addr)};
+    }
+
+public:
+    explicit LineIndex(Binary const* binary) : dwarf_(*binary) {
+        for (auto offset : dwarf_.lineUnits()) {
+            units_.emplace_back(new Unit {.offset = offset, .once = {}, .table = {}});
+        }
+        // Resolve each compile unit to its line program up front: one abbrev lookup per CU
+        std::unordered_map<uint64_t, size_t> cuUnits;  // .debug_info offset -> unit
+        auto unitOf = [&](uint64_t cu) {
+            auto [it, added] = cuUnits.try_emplace(cu, SIZE_MAX);
+            if (added) {
+                auto lineUnit = dwarf_.lineUnitOf(cu);
+                if (lineUnit) { it->second = unitAt(*lineUnit); }
+            }
+            return it->second;
+        };
+        try {
+            for (auto const& ar : dwarf_.aranges()) {
+                auto unit = unitOf(ar.unit);
+                if (unit != SIZE_MAX) { ranges_.push_back({ar.begin, ar.end, unit}); }
+            }
+        } catch (std::exception const& e) {
+            std::cerr << "cannot decode DWARF aranges: " << e.what() << std::endl;
+            ranges_.clear();
+            cuUnits.clear();
+        }
+
+        // Units not in `.debug_aranges` (the keys of `cuUnits`), or all of them without it: from
+        // their own ranges, and line program, read with the unit's entry
+        if (dwarf_.info_ && dwarf_.abbrev_) {
+            for (auto cu : dwarf_.infoUnits()) {
+                if (cuUnits.contains(cu)) { continue; }
+                try {
+                    DIEReader reader(dwarf_, cu);
+                    if (!reader.compileUnit_ || !reader.top_.stmtList) { continue; }
+                    auto unit = unitAt(reader.top_.stmtList->raw);
+                    if (unit == SIZE_MAX) { continue; }
+                    // (A unit with no ranges has no code: e.g. only data, or only declarations)
+                    reader.ranges(reader.top_, [&](uint64_t begin, uint64_t end) {
+                        ranges_.push_back({begin, end, unit});
+                    });
+                } catch (std::exception const& e) {
+                    std::cerr << "cannot decode DWARF: " << e.what() << std::endl;
+                    covered_ = false;
+                }
+            }
+        }
+        std::ranges::sort(ranges_, {}, &Range::begin);
+    }
+
+    size_t unitCount() const { return units_.size(); }
+
+    /**
+     * Decode every unit now, on `workers` threads (zero: one per hardware thread), then index
+     * their address ranges.  Units are independent, so each is decoded into its own table; only
+     * the small per-unit extents are merged.  Later calls return immediately.
+     */
+    void decodeAll(unsigned workers = 1) {
+        if (!workers) { workers = std::thread::hardware_concurrency(); }
+        std::call_once(allOnce_, [this, workers] {
+            if (workers > 1 && units_.size() > 1) {
+                auto decode = [this](size_t i) { return table(i).size(); };
+                auto indexes = std::views::iota(size_t(0), units_.size());
+                for (auto size : indexes | parallelMap(decode, workers)) { (void) size; }
+            }
+            for (size_t i = 0; i < units_.size(); i++) {
+                auto const& rows = table(i).rows();  // already decoded, if done in parallel
+                if (!rows.empty()) { spans_.push_back({rows.front().addr, rows.back().addr, i}); }
+            }
+            std::ranges::sort(spans_, {}, &Range::begin);
+            uint64_t reach = 0;
+            for (auto const& span : spans_) { reach_.push_back(reach = std::max(reach, span.end)); }
+        });
+    }
+
+    /** Decode all units (see `decodeAll`), and call `fn(row, file)` for each of their rows. */
+    template <typename F>
+    void forEachRow(F&& fn) {
+        decodeAll();
+        for (size_t i = 0; i < units_.size(); i++) {
+            auto const& lines = table(i);
+            for (auto const& row : lines.rows()) { fn(row, lines.file(row)); }
+        }
+    }
+
+    /** Number of units decoded so far. */
+    size_t decodedCount() const {
+        return std::ranges::count_if(units_, [](auto const& unit) { return !unit->table.empty(); });
+    }
+
+    /** The line table row covering (unslid) address `addr`, and the table it's in. */
+    Hit find(uint64_t addr) {
+        auto it = std::ranges::upper_bound(ranges_, addr, {}, &Range::begin);
+        if (it != ranges_.begin() && addr < (--it)->end) {
+            if (auto hit = findIn(it->unit, addr)) { return hit; }
+        }
+        if (covered_ && !ranges_.empty()) { return {}; }
+
+        decodeAll();
+        // Last span starting at or before `addr`, then back through any which overlap it
+        auto i = std::ranges::upper_bound(spans_, addr, {}, &Range::begin) - spans_.begin();
+        while (i-- > 0 && reach_[i] >= addr) {
+            if (addr > spans_[i].end) { continue; }
+            if (auto hit = findIn(spans_[i].unit, addr)) { return hit; }
+        }
+        return {};
+    }
+};
+
+}  // namespace cxx
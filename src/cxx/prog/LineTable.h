@@ -0,0 +1,105 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cxx {
+
+/**
+ * Maps addresses to source locations: the decoded form of a DWARF line program.
+ *
+ * Rows are packed into 16 bytes each: address, file ID (into an interned table of file names),
+ * line and column.  Each row covers the addresses from its own up to the next row's; a row
+ * with line 0 marks the end of a sequence, i.e. a gap with no location.  Consecutive rows with
+ * the same location are merged, since they tell us nothing new.
+ *
+ * To build, `intern` file names and `add` rows in any order, then `finish()`; after that the
+ * table is immutable and `find` may be called concurrently.
+ */
+class LineTable final {
+public:
+    constexpr static uint32_t kMaxLine = (1u << 20) - 1;  // larger values are clamped
+    constexpr static uint32_t kMaxCol = (1u << 12) - 1;
+
+    struct Row final {
+        uint64_t addr;
+        uint32_t file;
+        uint32_t line : 20;
+        uint32_t col : 12;
+
+        bool sameLocation(Row const& rhs) const {
+            return file == rhs.file && line == rhs.line && col == rhs.col;
+        }
+    };
+    static_assert(sizeof(Row) == 16);
+
+private:
+    std::vector<Row> rows_;
+    std::vector<std::string> files_;
+    std::unordered_map<std::string, uint32_t> fileIDs_;  // only while building
+
+public:
+    size_t size() const { return rows_.size(); }
+    bool empty() const { return rows_.empty(); }
+    std::vector<Row> const& rows() const { return rows_; }
+    std::string const& file(Row const& row) const { return files_[row.file]; }
+
+    /** ID of `name` in the file table, adding it if new. */
+    uint32_t intern(std::string const& name) {
+        auto [it, added] = fileIDs_.try_emplace(name, uint32_t(files_.size()));
+        if (added) { files_.push_back(name); }
+        return it->second;
+    }
+
+    void add(uint64_t addr, uint32_t file, uint32_t line, uint32_t col) {
+        rows_.push_back({addr, file, std::min(line, kMaxLine), std::min(col, kMaxCol)});
+    }
+
+    /** Mark the end of a sequence: no location at `addr` (until some other row's address). */
+    void addEnd(uint64_t addr) { rows_.push_back({addr, 0, 0, 0}); }
+
+    /**
+     * Sort and compact rows.  Where rows share an address, the last one added wins, except that
+     * any location wins over the end of a sequence: sequences needn't be in address order (e.g.
+     * with `-ffunction-sections`), so one may end just where the next one's first row is.
+     */
+    void finish() {
+        std::ranges::stable_sort(rows_, [](Row const& a, Row const& b) {
+            return a.addr != b.addr ? a.addr < b.addr : (!a.line && b.line);
+        });
+        std::vector<Row> out;
+        out.reserve(rows_.size());
+        for (size_t i = 0; i < rows_.size(); i++) {
+            auto const& row = rows_[i];
+            if (i + 1 < rows_.size() && rows_[i + 1].addr == row.addr) { continue; }
+            if (!out.empty() && out.back().sameLocation(row)) { continue; }
+            out.push_back(row);
+        }
+        out.shrink_to_fit();
+        rows_ = std::move(out);
+        fileIDs_ = {};
+    }
+
+    /** The row covering `addr`, or nullptr if none (or `addr` is in a gap). */
+    Row const* find(uint64_t addr) const {
+        if (rows_.empty() || addr < rows_.front().addr) { return nullptr; }
+        // Branch-free binary search for the last row at or before `addr`
+        auto const* base = rows_.data();
+        size_t n = rows_.size();
+        while (n > 1) {
+            auto half = n / 2;
+            base = (base[half].addr <= addr) ? base + half : base;
+            n -= half;
+        }
+        return base->line ? base : nullptr;
+    }
+};
+
+}  // namespace cxx
@@ -7,6 +7,7 @@ static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 #include "../io/File.h"
 #include "ObjectFile.h"
 #include "SourceLoc.h"
+#include "SymbolTable.h"
 
 #include <cstddef>
 #include <cstdint>
@@ -40,6 +41,7 @@ struct MachOBinary64 final : Binary {
     Cursor cur() const override;
 
     std::vector<Ref<Section>> sections() const override;
+    void readSymbols(SymbolTable* out) const override;
     static MachOBinary64 open(std::string path);
 };
 
@@ -96,6 +98,52 @@ std::vector<Ref<Section>> MachOBinary64::sections() const {
     return ret;
 }
 
+/*
+    Symbol table load command, 24 bytes:
+    +0                   +4                   +8                   +12
+    | LC_SYMTAB=0x02     | (@ 4) cmdsize      | (@ 8) symoff       | (@ 12) nsyms       |
+    | (@ 16) stroff      | (@ 20) strsize     |
+    Each symbol (`nlist_64`) is 16 bytes:
+    | (@ 0) strx         | type,sect,desc     | (@ 8) value                             |
+
+    Only symbols defined in some section are used (type & N_TYPE == N_SECT), not debugger
+    entries (type & N_STAB).  Sizes aren't recorded; `SymbolTable` infers them.  C/C++ names
+    have a leading underscore, which is dropped here.
+*/
+void MachOBinary64::readSymbols(SymbolTable* out) const {
+    constexpr static uint32_t kSymTab = 0x02;
+    constexpr static uint8_t kStab = 0xe0;
+    constexpr static uint8_t kTypeMask = 0x0e;
+    constexpr static uint8_t kSect = 0x0e;
+    constexpr static size_t kSymSize = 16;
+
+    auto cur = this->cur() + 0x20;
+    auto cmds = loadCommands_;
+    while (cmds--) {
+        auto cmd = cur.u32();
+        auto cmdSize = cur.u32();
+        if (cmd != kSymTab) {
+            cur += (cmdSize - 8);
+            continue;
+        }
+        auto symOff = cur.u32();
+        auto nsyms = cur.u32();
+        auto strOff = cur.u32();
+        auto strSize = cur.u32();
+        auto const file = this->cur();
+        for (size_t i = 0; i < nsyms; i++) {
+            auto sym = file + (symOff + i * kSymSize);
+            auto strx = sym.u32();
+            auto type = sym.u8();
+            if ((type & kStab) || (type & kTypeMask) != kSect || strx >= strSize) { continue; }
+            auto const* name = (char const*) (file.base_ + file.offset_ + strOff + strx);
+            if (*name == '_') { ++name; }
+            out->add((sym + 3).u64(), 0, name);
+        }
+        return;
+    }
+}
+
 /*
     Section layout, 80 (0x50) bytes:
     https://github.com/aidansteele/osx-abi-macho-file-format-reference?tab=readme-ov-file#section_64
@@ -113,7 +161,9 @@ Binary const* MachOSection64::binary() const { return binary_; }
 
 Cursor MachOSection64::contents() const {
     size_t offset = (cur() + 48).u32();
-    return (binary()->cur() + offset);
+    size_t size = (cur() + 40).u64();
+    auto file = binary()->cur();
+    return {file.owner_, file.base_ + offset, size};
 }
 
 }  // namespace cxx
@@ -4,15 +4,23 @@ static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 
 #include "../io/Bytes.h"
 #include "../io/File.h"
+#include "../ref/Ref.h"
 #include "SourceLoc.h"
+#include "SymbolTable.h"
 
 #include <cstdint>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 namespace cxx {
 
+class FunctionIndex;
+class LineIndex;
+class SymbolIndex;
+
 /** A section has code / data / something else (like debug info, which is what we're after).
  * These are generally within segments (don't care about those). */
 struct Section : Bytes {
@@ -22,17 +30,67 @@ struct Section : Bytes {
     virtual Binary const* binary() const = 0;
 };
 
+/** A `.gnu_debuglink`: the name of the file with a binary's debug info, and that file's CRC-32. */
+struct DebugLink final {
+    std::string file;
+    uint32_t crc;
+};
+
 /** A binary is a program, shared lib, or debug data.  It has segments (which have sections),
 and is represented by a blob of bytes, which this (actually a subclass of this) will parse,
 with the ultimate goal of providing a table of `SourceLoc`s. */
 struct Binary : Bytes {
     Ref<File> file_;
     uint64_t vmaSlide_;
+    std::once_flag mutable linesOnce_;
+    Ref<LineIndex> mutable lines_;  // see `lines()`
+    std::once_flag mutable functionsOnce_;
+    Ref<FunctionIndex> mutable functions_;  // see `functions()`
+    std::once_flag mutable symbolsOnce_;
+    SymbolTable mutable symbols_;  // see `symbols()`
+    std::once_flag mutable debugFilesOnce_;
+    std::vector<Ref<Binary>> mutable debugFiles_;  // see `debugFiles()`
+    std::once_flag mutable symbolIndexOnce_;
+    Ref<SymbolIndex> mutable symbolIndex_;  // see `symbolIndex()`
 
     Binary(Ref<File> file, uintptr_t vmaSlide) : file_(std::move(file)), vmaSlide_(vmaSlide) {}
     virtual ~Binary() = default;
     virtual std::vector<Ref<Section>> sections() const = 0;
 
+    /** The slide if this were loaded at `loadBase` (e.g. `dli_fbase` from `dladdr`); `vmaSlide_`
+     * if that's 0.  By default always `vmaSlide_`: the constructor's is assumed correct. */
+    virtual uint64_t slideAt(uintptr_t loadBase) const { return vmaSlide_; }
+
+    /** Given where this was actually loaded, adjust `vmaSlide_`.  For a binary shared by several
+     * loads of it (e.g. in `BinaryCache`), pass each one's base to `slideAt` instead. */
+    void rebase(uintptr_t loadBase) { vmaSlide_ = slideAt(loadBase); }
+
+    /** Add this binary's function symbols (with unslid addresses) to `out`.  Default: none. */
+    virtual void readSymbols(SymbolTable* out) const {}
+
+    /** This build's unique ID (ELF `NT_GNU_BUILD_ID`), in hex; empty if none.  Default: none. */
+    virtual std::string buildID() const { return {}; }
+
+    /** The `.gnu_debuglink` naming a separate debug info file, if any.  Default: none. */
+    virtual std::optional<DebugLink> debugLink() const { return std::nullopt; }
+
+    /** Separate files with this binary's debug info (see `DebugFiles`); found on the first call. */
+    std::vector<Ref<Binary>> const& debugFiles() const;
+
+    /** Function symbols, by (unslid) address.  Read on the first call; safe from any thread. */
+    SymbolTable const& symbols() const;
+
+    /** Line tables, keyed by (unslid) address.  Created on the first call, but each unit of the
+     * debug info is only decoded when a lookup needs it.  Safe to call from any thread. */
+    LineIndex& lines() const;
+
+    /** Functions (and inlined calls in them) by address; like `lines()`, read a unit at a time. */
+    FunctionIndex const& functions() const;
+
+    /** This build's `SymbolIndex`, if `SymbolIndexCache` is enabled (written there if need be);
+     * else nullptr.  When there is one, lookups use it instead of the tables above. */
+    SymbolIndex const* symbolIndex() const;
+
     static Ref<Binary> open(std::string const& path, uintptr_t vmaSlide);
 };
 
@@ -0,0 +1,190 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "../io/Cursor.h"
+#include "../ref/Ref.h"
+#include "DIE.h"
+#include "DWARF.h"
+#include "ObjectFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cxx {
+
+/** Part of a section: in a `.dwp` package, one unit's contribution to it. */
+struct SectionSlice final : Section {
+    Ref<Section> section_;
+    uint64_t offset_;
+    uint64_t size_;
+
+    SectionSlice(Ref<Section> section, uint64_t offset, uint64_t size)
+            : section_(std::move(section))
+            , offset_(offset)
+            , size_(size) {}
+
+    Cursor cur() const override { return contents(); }
+    std::string name() const override { return section_->name(); }
+    Binary const* binary() const override { return section_->binary(); }
+
+    Cursor contents() const override {
+        auto whole = section_->contents();
+        return {whole.owner_, whole.base_ + offset_, size_};
+    }
+};
+
+/**
+ * Split DWARF (`-gsplit-dwarf`) leaves most of each compile unit's debug info out of the binary:
+ * only a "skeleton" unit remains, naming the `.dwo` file with the rest.  The `.dwo`s may also be
+ * combined into one `.dwp` package, placed beside the binary.  What stays in the binary is what
+ * the linker had to relocate: line tables, and the addresses (`.debug_addr`) which the split
+ * units refer to by index.
+ * https://dwarfstd.org/doc/DWARF5.pdf (sections 3.1.3 and 7.3)
+ */
+class SplitDWARF final {
+public:
+    /** A split unit's DWARF; the file it's in is kept open while this exists. */
+    struct Unit final {
+        Ref<Binary> file;
+        DWARF dwarf;      // that file's sections (in a `.dwp`, just this unit's parts of them)
+        uint64_t offset;  // of the unit, in `dwarf.info_`
+    };
+
+private:
+    Binary const* binary_;
+    Ref<Section> addr_;  // the binary's `.debug_addr`
+    std::once_flag dwpOnce_;
+    Ref<Binary> dwp_;
+    DWARF dwpDWARF_;
+
+    std::string dir() const {
+        auto const& path = binary_->file_->path_;
+        auto slash = path.rfind('/');
+        return (slash == std::string::npos) ? "." : path.substr(0, slash);
+    }
+
+    /** The split unit in `file` matching `skeleton` (by ID; or if IDs are unknown, the first). */
+    std::optional<Unit> unitIn(Ref<Binary> file, DWARF dwarf, DIEReader const& skeleton) const {
+        dwarf.addr_ = addr_;
+        if (!dwarf.info_ || !dwarf.abbrev_) { return std::nullopt; }
+        for (auto offset : dwarf.infoUnits()) {
+            DIEReader reader(dwarf, offset, &skeleton);
+            if (!reader.compileUnit_) { continue; }
+            if (reader.dwoID_ == skeleton.dwoID_ || !reader.dwoID_ || !skeleton.dwoID_) {
+                return Unit {std::move(file), std::move(dwarf), offset};
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<Unit> fromDWO(DIEReader const& skeleton) const {
+        auto name = skeleton.string(*skeleton.top_.dwoName);
+        if (name.empty()) { return std::nullopt; }
+        std::vector<std::string> paths;
+        if (name.starts_with("/")) {
+            paths.push_back(name);
+        } else {
+            if (skeleton.top_.compDir) {
+                paths.push_back(skeleton.string(*skeleton.top_.compDir) + "/" + name);
+            }
+            paths.push_back(dir() + "/" + name);  // e.g. built elsewhere, and copied here
+        }
+        for (auto const& path : paths) {
+            if (auto file = Binary::open(path, binary_->vmaSlide_)) {
+                DWARF dwarf(*file);
+                return unitIn(std::move(file), std::move(dwarf), skeleton);
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<Unit> fromDWP(DIEReader const& skeleton);
+
+public:
+    SplitDWARF(Binary const* binary, DWARF const& dwarf) : binary_(binary), addr_(dwarf.addr_) {}
+
+    /** The split unit for `skeleton`, from the binary's `.dwp` if it has one, else its `.dwo`. */
+    std::optional<Unit> find(DIEReader const& skeleton) {
+        if (!skeleton.skeleton()) { return std::nullopt; }
+        if (auto ret = fromDWP(skeleton)) { return ret; }
+        return fromDWO(skeleton);
+    }
+};
+
+/*
+    `.debug_cu_index` in a `.dwp` (version 5; version 2 is the GNU extension for DWARF 4):
+    +0                   +4                   +8                   +12
+    | version, padding   | (@ 4) columns      | (@ 8) units        | (@ 12) slots       |
+    then `slots` u64 unit IDs: a hash table, where zero means empty;
+    then `slots` u32 rows, for those IDs (numbered from 1);
+    then `columns` u32 section IDs (DW_SECT_*);
+    then for each row, a u32 offset for each column: where the unit's part of that section is;
+    then likewise, each part's size.
+*/
+std::optional<SplitDWARF::Unit> SplitDWARF::fromDWP(DIEReader const& skeleton) {
+    std::call_once(dwpOnce_, [this] {
+        dwp_ = Binary::open(binary_->file_->path_ + ".dwp", binary_->vmaSlide_);
+        if (dwp_) { dwpDWARF_ = DWARF(*dwp_); }
+    });
+    if (!dwp_ || !dwpDWARF_.cuIndex_ || !skeleton.dwoID_) { return std::nullopt; }
+
+    auto index = dwpDWARF_.cuIndex_->contents();
+    auto version = index.peekU16(0);
+    uint64_t columns = index.peekU32(4);
+    uint64_t units = index.peekU32(8);
+    uint64_t slots = index.peekU32(12);
+    if ((version != 2 && version != 5) || !slots || (slots & (slots - 1))) { return std::nullopt; }
+    auto const ids = 16;
+    auto const rows = ids + slots * 8;
+    auto const sectionIDs = rows + slots * 4;
+    auto const offsets = sectionIDs + columns * 4;
+    auto const sizes = offsets + units * columns * 4;
+    if (sizes + units * columns * 4 > index.size_) { return std::nullopt; }
+
+    // Open addressing: step by an odd amount (from the ID's high bits), so all slots are visited
+    auto const id = skeleton.dwoID_;
+    auto const mask = slots - 1;
+    auto const step = ((id >> 32) & mask) | 1;
+    uint64_t row = 0;
+    for (uint64_t slot = id & mask, n = 0; n < slots; slot = (slot + step) & mask, n++) {
+        auto slotID = index.peekU64(ids + slot * 8);
+        auto slotRow = index.peekU32(rows + slot * 4);
+        if (slotID == id && slotRow) {
+            row = slotRow;
+            break;
+        }
+        if (!slotID && !slotRow) { return std::nullopt; }
+    }
+    if (!row || row > units) { return std::nullopt; }
+
+    // DW_SECT_* IDs; only `.debug_rnglists` (DWARF 5) has different IDs in the two versions
+    constexpr static uint32_t kInfo = 1, kAbbrev = 3, kLine = 4, kStrOffsets = 6, kRnglists = 8;
+    auto dwarf = dwpDWARF_;
+    for (uint64_t col = 0; col < columns; col++) {
+        auto cell = ((row - 1) * columns + col) * 4;
+        auto slice = [&](Ref<Section>& section) {
+            if (!section) { return; }
+            auto offset = index.peekU32(offsets + cell);
+            auto size = index.peekU32(sizes + cell);
+            section = Ref<SectionSlice>::make(section, offset, size);
+        };
+        switch (index.peekU32(sectionIDs + col * 4)) {
+        case kInfo:       slice(dwarf.info_); break;
+        case kAbbrev:     slice(dwarf.abbrev_); break;
+        case kLine:       slice(dwarf.line_); break;
+        case kStrOffsets: slice(dwarf.strOffsets_); break;
+        case kRnglists:
+            if (version == 5) { slice(dwarf.rnglists_); }
+            break;
+        }
+    }
+    return unitIn(dwp_, std::move(dwarf), skeleton);
+}
+
+}  // namespace cxx
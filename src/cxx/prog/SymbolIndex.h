@@ -0,0 +1,299 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "../io/File.h"
+#include "../ref/Ref.h"
+#include "FunctionIndex.h"
+#include "LineIndex.h"
+#include "LineTable.h"
+#include "ObjectFile.h"
+#include "SymbolTable.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace cxx {
+
+/**
+ * A binary's line tables, functions (with inlined calls) and symbols, flattened into a file
+ * which is mapped and used as is, with no decoding: a persistent form of what `LineIndex`,
+ * `FunctionIndex` and `SymbolTable` find.  For processes which can't afford to decode DWARF
+ * before their first stack trace; see `SymbolIndexCache`.
+ *
+ * The file is a `Header`, then arrays of fixed-size records (`Line`s, `Func`s, `Call`s,
+ * `Symbol`s), each sorted by address, then the strings they refer to, by offset.  Integers are
+ * in host byte order; files of another version or byte order are rejected, as are files written
+ * for some other build of the binary.  Files are written to a temporary name then renamed, so a
+ * reader never sees a partly written one.
+ */
+class SymbolIndex final {
+public:
+    constexpr static char kMagic[8] = {'c', 'x', 'x', 's', 'y', 'm', 'i', 'x'};
+    constexpr static uint32_t kVersion = 1;
+    constexpr static uint32_t kByteOrder = 0x01020304;
+
+    struct Header final {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;  // `kByteOrder`, as written
+        uint64_t buildID;    // in strings: the build ID, in hex
+        uint64_t lineCount;
+        uint64_t funcCount;
+        uint64_t callCount;
+        uint64_t symbolCount;
+        uint64_t stringsSize;
+    };
+
+    /** Location from `addr` up to the next `Line`'s; line 0 means none (a gap). */
+    struct Line final {
+        uint64_t addr;
+        uint32_t file;     // in strings
+        uint32_t lineCol;  // line (20 bits), then column (12 bits), as in `LineTable::Row`
+    };
+
+    /** A range of a function; its inlined calls there are `calls[firstCall, +callCount)`. */
+    struct Func final {
+        uint64_t begin;
+        uint64_t end;
+        uint32_t name;
+        uint32_t firstCall;
+        uint32_t callCount;
+        uint32_t reserved;
+    };
+
+    struct Call final {
+        uint64_t begin;
+        uint64_t end;
+        uint32_t name;
+        uint32_t depth;
+        uint32_t callFile;
+        uint32_t callLine;
+        uint32_t callCol;
+        uint32_t reserved;
+    };
+
+    struct Symbol final {
+        uint64_t addr;
+        uint64_t size;
+        uint32_t name;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(Header) == 64 && sizeof(Line) == 16 && sizeof(Func) == 32);
+    static_assert(sizeof(Call) == 40 && sizeof(Symbol) == 24);
+
+    struct Location final {
+        uint64_t addr;  // of the `Line` found
+        char const* file;
+        uint32_t line;
+        uint32_t col;
+    };
+
+private:
+    Ref<File> file_;
+    std::span<Line const> lines_;
+    std::span<Func const> funcs_;
+    std::span<Call const> calls_;
+    std::span<Symbol const> symbols_;
+    std::span<char const> strings_;
+
+    char const* string(uint32_t offset) const {
+        return offset < strings_.size() ? strings_.data() + offset : "";
+    }
+
+public:
+    /** Map the index at `path`, if it's valid, and for build `buildID`; else empty. */
+    static Ref<SymbolIndex> load(std::string const& path, std::string const& buildID);
+
+    /**
+     * Write the index for build `buildID`, from `sources`: the binary, and any separate debug
+     * info files.  Lines and functions are taken from the first source with any (decoding all
+     * of them), and symbols from the one with the most.  Returns false if it couldn't be written.
+     */
+    static bool write(std::string const& path, std::string const& buildID,
+                      std::vector<Binary const*> const& sources);
+
+    size_t lineCount() const { return lines_.size(); }
+    size_t funcCount() const { return funcs_.size(); }
+    size_t symbolCount() const { return symbols_.size(); }
+
+    /** Source location of (unslid) address `addr`, as from `LineIndex::find`. */
+    std::optional<Location> line(uint64_t addr) const {
+        auto it = std::ranges::upper_bound(lines_, addr, {}, &Line::addr);
+        if (it == lines_.begin() || !((--it)->lineCol >> 12)) { return std::nullopt; }
+        return Location {it->addr, string(it->file), it->lineCol >> 12, it->lineCol & 0xfff};
+    }
+
+    /** Functions at `addr`, innermost first, as from `FunctionIndex::find`. */
+    std::vector<FunctionIndex::Scope> functions(uint64_t addr) const {
+        std::vector<FunctionIndex::Scope> ret;
+        auto it = std::ranges::upper_bound(funcs_, addr, {}, &Func::begin);
+        if (it == funcs_.begin() || addr >= (--it)->end) { return ret; }
+        std::vector<Call const*> chain;
+        auto calls = calls_.subspan(std::min<size_t>(it->firstCall, calls_.size()));
+        for (auto const& call : calls.first(std::min<size_t>(it->callCount, calls.size()))) {
+            if (addr >= call.begin && addr < call.end) { chain.push_back(&call); }
+        }
+        std::ranges::sort(chain, std::greater {}, &Call::depth);
+        for (auto const* call : chain) {
+            ret.push_back({string(call->name), string(call->callFile), call->callLine,
+                           call->callCol});
+        }
+        ret.push_back({string(it->name), nullptr, 0, 0});
+        return ret;
+    }
+
+    /** Name of the symbol covering `addr`, as from `SymbolTable::find`; or nullptr. */
+    char const* symbol(uint64_t addr) const {
+        auto it = std::ranges::upper_bound(symbols_, addr, {}, &Symbol::addr);
+        if (it == symbols_.begin()) { return nullptr; }
+        --it;
+        bool covers = (addr - it->addr < it->size) || (addr == it->addr);
+        return covers ? string(it->name) : nullptr;
+    }
+};
+
+Ref<SymbolIndex> SymbolIndex::load(std::string const& path, std::string const& buildID) {
+    auto file = File::open(path);
+    if (!file || file->size_ < sizeof(Header)) { return {}; }
+    auto const* base = (uint8_t const*) file->mmap_;
+    auto const& hdr = *(Header const*) base;
+    if (std::memcmp(hdr.magic, kMagic, sizeof(kMagic)) || hdr.version != kVersion ||
+        hdr.byteOrder != kByteOrder) {
+        return {};
+    }
+    // Check sizes before adding them up, so a corrupt file can't make them wrap around
+    constexpr static uint64_t kMaxCount = uint64_t(1) << 40;
+    for (auto count : {hdr.lineCount, hdr.funcCount, hdr.callCount, hdr.symbolCount}) {
+        if (count > kMaxCount) { return {}; }
+    }
+    auto lines = sizeof(Header);
+    auto funcs = lines + hdr.lineCount * sizeof(Line);
+    auto calls = funcs + hdr.funcCount * sizeof(Func);
+    auto symbols = calls + hdr.callCount * sizeof(Call);
+    auto strings = symbols + hdr.symbolCount * sizeof(Symbol);
+    if (hdr.stringsSize > kMaxCount || strings + hdr.stringsSize != file->size_) { return {}; }
+    if (!hdr.stringsSize || base[file->size_ - 1]) { return {}; }  // last string unterminated
+
+    auto ret = Ref<SymbolIndex>::make();
+    ret->lines_ = {(Line const*) (base + lines), hdr.lineCount};
+    ret->funcs_ = {(Func const*) (base + funcs), hdr.funcCount};
+    ret->calls_ = {(Call const*) (base + calls), hdr.callCount};
+    ret->symbols_ = {(Symbol const*) (base + symbols), hdr.symbolCount};
+    ret->strings_ = {(char const*) (base + strings), hdr.stringsSize};
+    if (hdr.buildID >= hdr.stringsSize || buildID != ret->string(hdr.buildID)) { return {}; }
+    ret->file_ = std::move(file);
+    return ret;
+}
+
+bool SymbolIndex::write(std::string const& path, std::string const& buildID,
+                        std::vector<Binary const*> const& sources) {
+    std::string strings;
+    std::unordered_map<std::string, uint32_t> stringIDs;
+    auto intern = [&](std::string const& str) {
+        auto [it, added] = stringIDs.try_emplace(str, uint32_t(strings.size()));
+        if (added) { strings.append(str.data(), str.size() + 1); }
+        return it->second;
+    };
+
+    Header hdr {};
+    std::memcpy(hdr.magic, kMagic, sizeof(kMagic));
+    hdr.version = kVersion;
+    hdr.byteOrder = kByteOrder;
+    hdr.buildID = intern(buildID);
+
+    // Rows of all units, merged as `LineTable` merges a unit's
+    LineTable merged;
+    for (auto const* bin : sources) {
+        if (!bin->lines().unitCount()) { continue; }
+        bin->lines().forEachRow([&](LineTable::Row const& row, std::string const& file) {
+            if (!row.line) { return merged.addEnd(row.addr); }
+            merged.add(row.addr, merged.intern(file), row.line, row.col);
+        });
+        break;
+    }
+    merged.finish();
+    std::vector<Line> lines;
+    for (auto const& row : merged.rows()) {
+        auto file = row.line ? intern(merged.file(row)) : intern("");
+        lines.push_back({row.addr, file, uint32_t(row.line) << 12 | row.col});
+    }
+
+    std::vector<Func> funcs;
+    std::vector<Call> calls;
+    for (auto const* bin : sources) {
+        if (!bin->functions().unitCount()) { continue; }
+        bin->functions().forEachFunction([&](uint64_t begin, uint64_t end, std::string const& name,
+                                             std::vector<FunctionIndex::InlinedCall> const& in) {
+            funcs.push_back({begin, end, intern(name), uint32_t(calls.size()),
+                             uint32_t(in.size()), 0});
+            for (auto const& call : in) {
+                calls.push_back({call.begin, call.end, intern(call.scope.name), call.depth,
+                                 intern(call.scope.callFile), call.scope.callLine,
+                                 call.scope.callCol, 0});
+            }
+        });
+        break;
+    }
+    std::ranges::sort(funcs, {}, &Func::begin);
+
+    std::vector<Symbol> symbols;
+    Binary const* symbolSource = nullptr;
+    for (auto const* bin : sources) {
+        if (!symbolSource || bin->symbols().size() > symbolSource->symbols().size()) {
+            symbolSource = bin;
+        }
+    }
+    if (symbolSource) {
+        for (auto const& sym : symbolSource->symbols().symbols()) {
+            symbols.push_back({sym.addr, sym.size, intern(sym.name), 0});
+        }
+    }
+
+    hdr.lineCount = lines.size();
+    hdr.funcCount = funcs.size();
+    hdr.callCount = calls.size();
+    hdr.symbolCount = symbols.size();
+    hdr.stringsSize = strings.size();
+
+    auto tmp = path + ".tmp" + std::to_string(getpid());
+    int fd = ::open(tmp.data(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) { return false; }
+    bool ok = true;
+    auto put = [&](void const* data, size_t size) {
+        auto const* ptr = (char const*) data;
+        while (ok && size) {
+            auto n = ::write(fd, ptr, size);
+            if (n <= 0) {
+                ok = false;
+            } else {
+                ptr += n;
+                size -= size_t(n);
+            }
+        }
+    };
+    put(&hdr, sizeof(hdr));
+    put(lines.data(), lines.size() * sizeof(Line));
+    put(funcs.data(), funcs.size() * sizeof(Func));
+    put(calls.data(), calls.size() * sizeof(Call));
+    put(symbols.data(), symbols.size() * sizeof(Symbol));
+    put(strings.data(), strings.size());
+    ok = (::close(fd) == 0) && ok;
+    if (ok) { ok = (std::rename(tmp.data(), path.data()) == 0); }
+    if (!ok) { ::unlink(tmp.data()); }
+    return ok;
+}
+
+}  // namespace cxx
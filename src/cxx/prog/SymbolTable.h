@@ -0,0 +1,80 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace cxx {
+
+/**
+ * Function symbols of a binary, sorted by address, for mapping addresses to names without
+ * `dladdr`.  Unlike `dladdr` this includes non-exported (e.g. `static`) functions, if the
+ * binary wasn't stripped, and lookups take no locks.
+ *
+ * Names point into the binary's own (mapped) string table, so are valid as long as it is.
+ * To build, `add` symbols in any order, then `finish()`; after that the table is immutable and
+ * `find` may be called concurrently.
+ */
+class SymbolTable final {
+public:
+    struct Symbol final {
+        uint64_t addr;
+        uint64_t size;  // zero if unknown (and not inferrable); then only `addr` itself matches
+        char const* name;
+    };
+
+private:
+    std::vector<Symbol> syms_;
+
+public:
+    size_t size() const { return syms_.size(); }
+    bool empty() const { return syms_.empty(); }
+    std::vector<Symbol> const& symbols() const { return syms_; }
+
+    void add(uint64_t addr, uint64_t size, char const* name) {
+        if (name && *name) { syms_.push_back({addr, size, name}); }
+    }
+
+    /**
+     * Sort by address.  Of several symbols at one address (aliases), keep the first one with a
+     * size.  Symbols with no size are taken to extend to the next symbol.
+     */
+    void finish() {
+        std::ranges::stable_sort(syms_, {}, &Symbol::addr);
+        std::vector<Symbol> out;
+        out.reserve(syms_.size());
+        for (auto const& sym : syms_) {
+            if (!out.empty() && out.back().addr == sym.addr) {
+                if (!out.back().size && sym.size) { out.back() = sym; }
+                continue;
+            }
+            out.push_back(sym);
+        }
+        for (size_t i = 0; i + 1 < out.size(); i++) {
+            if (!out[i].size) { out[i].size = out[i + 1].addr - out[i].addr; }
+        }
+        out.shrink_to_fit();
+        syms_ = std::move(out);
+    }
+
+    /** The symbol covering `addr`, or nullptr if none. */
+    Symbol const* find(uint64_t addr) const {
+        if (syms_.empty() || addr < syms_.front().addr) { return nullptr; }
+        // Branch-free binary search for the last symbol at or before `addr`
+        auto const* base = syms_.data();
+        size_t n = syms_.size();
+        while (n > 1) {
+            auto half = n / 2;
+            base = (base[half].addr <= addr) ? base + half : base;
+            n -= half;
+        }
+        bool covers = (addr - base->addr < base->size) || (addr == base->addr);
+        return covers ? base : nullptr;
+    }
+};
+
+}  // namespace cxx
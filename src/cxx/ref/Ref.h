@@ -44,19 +44,24 @@ struct Ref final {
         block_ = nullptr;  // clear pointer so we can't refer to object anymore
     }
 
+    // These take `rhs`'s block before releasing ours: `rhs` may live in the object we release
+    // (e.g. `node = node->next`), or be this very `Ref`.
+
     template <typename U>
     Ref<T>& copyFrom(Ref<U> const& rhs) {
-        clear();                          // first release our reference (if any)
-        block_ = (Block*) rhs.block_;     // copy other's block
-        if (block_) { ++block_->refs_; }  // bump reference count
+        auto* block = (Block*) rhs.block_;  // copy other's block
+        if (block) { ++block->refs_; }      // bump reference count
+        clear();                            // then release our reference (if any)
+        block_ = block;
         return *this;
     }
 
     template <typename U>
     Ref<T>& moveFrom(Ref<U>&& rhs) {
-        clear();                       // first release our reference (if any)
-        block_ = (Block*) rhs.block_;  // take other's block; no change in refcount
-        rhs.block_ = nullptr;          // we took their block, so clear their pointer
+        auto* block = (Block*) rhs.block_;  // take other's block; no change in refcount
+        rhs.block_ = nullptr;               // we took their block, so clear their pointer
+        clear();                            // then release our reference (if any)
+        block_ = block;
         return *this;
     }
 
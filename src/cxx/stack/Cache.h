@@ -0,0 +1,91 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "../prog/ObjectFile.h"
+#include "../ref/Ref.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace cxx {
+
+/**
+ * Process-wide cache of opened `Binary`s, keyed by path, shared by all `StackResolver`s.
+ * Each file is opened (and each of its line tables decoded, see `Binary::lines`) at most once;
+ * paths which can't be opened are remembered too, so they aren't retried for every frame.
+ * A binary's `vmaSlide_` is only a default: one file may be loaded at several addresses (in
+ * another process, or after a `dlclose` and `dlopen`), so lookups take the slide of the load
+ * they're for from `Binary::slideAt`.
+ *
+ * Lookups are lock-free: entries are in a fixed table of buckets, each a list which is only
+ * ever prepended to (under a lock), and published through an atomic pointer.  Entries are never
+ * removed, so a reader can't see one freed; and each is one allocation, never copied.
+ */
+class BinaryCache final {
+    constexpr static size_t kBuckets = 1024;
+
+    struct Entry final {
+        std::string path;
+        Ref<Binary> binary;  // empty if `path` couldn't be opened
+        Entry const* next;   // in the same bucket
+    };
+
+    std::atomic<Entry const*> buckets_[kBuckets] {};
+    std::mutex mutex_;  // held while adding entries
+
+    std::atomic<Entry const*>& bucket(std::string const& path) {
+        return buckets_[std::hash<std::string> {}(path) % kBuckets];
+    }
+
+    static Entry const* find(Entry const* entry, std::string const& path) {
+        for (; entry; entry = entry->next) {
+            if (entry->path == path) { return entry; }
+        }
+        return nullptr;
+    }
+
+public:
+    static BinaryCache& get() {
+        // Never destroyed, since stack traces might still be dumped during static destruction
+        static auto* ret = new BinaryCache();
+        return *ret;
+    }
+
+    /**
+     * Get the binary at `path`, opening it on first request (with the given default VMA slide).
+     * Returns an empty `Ref` if not openable.
+     */
+    Ref<Binary> open(std::string const& path, uintptr_t vmaSlide) {
+        auto& head = bucket(path);
+        if (auto* entry = find(head.load(std::memory_order_acquire), path)) {
+            return entry->binary;
+        }
+
+        std::lock_guard lock(mutex_);
+        auto const* first = head.load(std::memory_order_acquire);
+        if (auto* entry = find(first, path)) { return entry->binary; }  // raced; already added
+        auto* entry = new Entry {path, Binary::open(path, vmaSlide), first};
+        head.store(entry, std::memory_order_release);
+        return entry->binary;
+    }
+
+    /** Number of paths looked up so far (opened or not). */
+    size_t size() {
+        std::lock_guard lock(mutex_);
+        size_t ret = 0;
+        for (auto const& head : buckets_) {
+            for (auto const* entry = head.load(std::memory_order_acquire); entry;
+                 entry = entry->next) {
+                ++ret;
+            }
+        }
+        return ret;
+    }
+};
+
+}  // namespace cxx
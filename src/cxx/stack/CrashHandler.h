@@ -0,0 +1,293 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "../ref/Ref.h"
+#include "Frame.h"
+#include "Modules.h"
+#include "Trace.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <signal.h>
+#include <sstream>
+#include <string>
+#include <sys/ucontext.h>
+#include <unistd.h>
+#include <vector>
+
+namespace cxx {
+
+namespace detail {
+
+/**
+ * Program counter and frame pointer of the code a signal interrupted, from the handler's
+ * `ucontext_t`; false where this doesn't know the platform's layout.  (The handler's own frame
+ * chain doesn't lead there reliably: the kernel's signal trampoline has no frame record, and the
+ * handler may be running on an alternate stack.)
+ */
+inline bool interruptedAt(void const* ucontext, uintptr_t* pc, void** fp) {
+    if (!ucontext) { return false; }
+    [[maybe_unused]] auto const& uc = *(ucontext_t const*) ucontext;
+#if defined(__linux__) && defined(__x86_64__)
+    *pc = uintptr_t(uc.uc_mcontext.gregs[REG_RIP]);
+    *fp = (void*) uc.uc_mcontext.gregs[REG_RBP];
+    return true;
+#elif defined(__linux__) && defined(__aarch64__)
+    *pc = uintptr_t(uc.uc_mcontext.pc);
+    *fp = (void*) uc.uc_mcontext.regs[29];
+    return true;
+#elif defined(__APPLE__) && defined(__x86_64__)
+    *pc = uintptr_t(uc.uc_mcontext->__ss.__rip);
+    *fp = (void*) uc.uc_mcontext->__ss.__rbp;
+    return true;
+#elif defined(__APPLE__) && defined(__aarch64__)
+    *pc = uintptr_t(uc.uc_mcontext->__ss.__pc);
+    *fp = (void*) uc.uc_mcontext->__ss.__fp;
+    return true;
+#else
+    return false;
+#endif
+}
+
+/** Formats into a fixed buffer, and `write`s it out; no allocation, so usable in a handler. */
+class SignalWriter final {
+    int fd_;
+    size_t size_ {0};
+    char buf_[512];
+
+public:
+    explicit SignalWriter(int fd) : fd_(fd) {}
+    ~SignalWriter() { flush(); }
+
+    void flush() {
+        size_t done = 0;
+        while (done < size_) {
+            auto n = ::write(fd_, buf_ + done, size_ - done);
+            if (n <= 0) { break; }  // nothing else to be done about it, here
+            done += size_t(n);
+        }
+        size_ = 0;
+    }
+
+    SignalWriter& str(char const* str, size_t len) {
+        for (size_t i = 0; i < len; i++) {
+            if (size_ == sizeof(buf_)) { flush(); }
+            buf_[size_++] = str[i];
+        }
+        return *this;
+    }
+
+    SignalWriter& str(char const* str) {
+        size_t len = 0;
+        while (str[len]) { len++; }
+        return this->str(str, len);
+    }
+
+    SignalWriter& hex(uint64_t val) {
+        char digits[18] = {'0', 'x'};
+        for (int i = 0; i < 16; i++) { digits[17 - i] = "0123456789abcdef"[(val >> (4 * i)) & 15]; }
+        return str(digits, sizeof(digits));
+    }
+
+    SignalWriter& dec(uint64_t val) {
+        char digits[20];
+        size_t n = 0;
+        do { digits[sizeof(digits) - ++n] = char('0' + val % 10); } while (val /= 10);
+        return str(digits + sizeof(digits) - n, n);
+    }
+};
+
+}  // namespace detail
+
+/*
+    What the crash handler writes: one item per line, frames innermost first, then the
+    modules those frames are in (their address ranges; see `Module`).  Addresses in hex.
+        *** crash: signal 11 (SIGSEGV), address 0x0000000000000000
+        frame 0x000055d0c0de1234
+        frame 0x000055d0c0de0fed
+        [...]
+        module 0x000055d0c0de0000 0x000055d0c0e10000 /path/to/program
+        module 0x00007f0123400000 0x00007f01235d8000 /lib/x86_64-linux-gnu/libc.so.6
+        *** end
+*/
+
+/**
+ * Writes a stack trace when the program crashes (`SIGSEGV`, `SIGBUS`, `SIGILL`, `SIGFPE`,
+ * `SIGABRT`, `SIGTRAP`), as raw addresses with the bases of the modules they're in.  Signal
+ * handlers can't safely allocate, take locks, or read debug info, so this does none of that:
+ * it walks the stack into a buffer set aside by `install`, and writes with `write(2)` only.
+ * The trace can be symbolized later, in another process, with `read` and `StackFrame::resolve`.
+ *
+ * Modules are taken from `ModuleMap`'s latest snapshot: taken by `install`, and retaken when a
+ * lookup there misses (e.g. after a `dlopen`), but never by the handler itself.  The handlers
+ * installed before are restored after the trace is written, and the signal raised again, so
+ * e.g. a core dump is still produced.  The thread calling `install` gets an alternate signal
+ * stack, so that a stack overflow on it can be reported too.
+ *
+ * Frames are found by frame pointers, as for `StackTrace`: the walk stops at code built without
+ * them (e.g. within libc, for `abort`).
+ */
+class CrashHandler final {
+public:
+    constexpr static int kSignals[] = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT, SIGTRAP};
+    constexpr static size_t kAltStackSize = 64 << 10;
+
+private:
+    constexpr static size_t kSignalCount = sizeof(kSignals) / sizeof(kSignals[0]);
+
+    std::atomic<int> fd_ {-1};  // -1 if not installed
+    std::atomic<bool> crashing_ {false};
+    struct sigaction previous_[kSignalCount] {};
+    void const* frames_[StackTrace::kMaxDepth] {};
+    char* altStack_ {nullptr};
+
+    static char const* signalName(int sig) {
+        switch (sig) {
+        case SIGSEGV: return "SIGSEGV";
+        case SIGBUS:  return "SIGBUS";
+        case SIGILL:  return "SIGILL";
+        case SIGFPE:  return "SIGFPE";
+        case SIGABRT: return "SIGABRT";
+        case SIGTRAP: return "SIGTRAP";
+        default:      return "?";
+        }
+    }
+
+    static Module const* moduleAt(std::vector<Module> const& modules, uintptr_t addr) {
+        for (auto const& mod : modules) {
+            if (addr >= mod.begin && addr < mod.end) { return &mod; }
+        }
+        return nullptr;
+    }
+
+    static void handle(int sig, siginfo_t* info, void* ucontext) {
+        auto& self = get();
+        // Only the first thread to crash reports; any other waits here to be killed with it
+        if (self.crashing_.exchange(true)) {
+            while (true) { ::pause(); }
+        }
+        bool fault = info && info->si_code > 0;  // raised by the CPU; not `kill`, `raise`, etc.
+        self.write(self.fd_.load(), sig, fault ? info->si_addr : nullptr, ucontext);
+
+        for (size_t i = 0; i < kSignalCount; i++) {
+            if (kSignals[i] == sig) { ::sigaction(sig, &self.previous_[i], nullptr); }
+        }
+        // A fault recurs on return, now with the previous handler; anything else (`abort`,
+        // `raise`, or a breakpoint, which returns past itself), raise again
+        if (!fault || sig == SIGTRAP) { ::raise(sig); }
+    }
+
+public:
+    static CrashHandler& get() {
+        // Never destroyed, since a crash could happen during static destruction
+        static auto* ret = new CrashHandler();
+        return *ret;
+    }
+
+    /** Report crashes to `fd` (default: stderr).  Calling this again only changes `fd`. */
+    void install(int fd = STDERR_FILENO) {
+        if (fd_.exchange(fd) != -1) { return; }
+        ModuleMap::get().refresh();
+
+        if (!altStack_) { altStack_ = new char[kAltStackSize]; }
+        stack_t altStack {};
+        altStack.ss_sp = altStack_;
+        altStack.ss_size = kAltStackSize;
+        ::sigaltstack(&altStack, nullptr);
+
+        struct sigaction action {};
+        action.sa_sigaction = &handle;
+        action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+        sigemptyset(&action.sa_mask);
+        for (size_t i = 0; i < kSignalCount; i++) {
+            ::sigaction(kSignals[i], &action, &previous_[i]);
+        }
+    }
+
+    /** Restore the handlers there were before `install`. */
+    void uninstall() {
+        if (fd_.exchange(-1) == -1) { return; }
+        for (size_t i = 0; i < kSignalCount; i++) {
+            ::sigaction(kSignals[i], &previous_[i], nullptr);
+        }
+    }
+
+    /**
+     * Write the trace of a crash (in the format above) to `fd`.  With the `ucontext` of a signal
+     * handler, the trace starts where the signal interrupted; otherwise, at the caller.
+     * Async-signal-safe; but uses one buffer, so only one thread may call this at a time.
+     */
+    void write(int fd, int sig, void const* addr, void const* ucontext) {
+        detail::SignalWriter out(fd);
+        out.str("*** crash: signal ").dec(uint64_t(sig));
+        out.str(" (").str(signalName(sig)).str("), address ").hex(uintptr_t(addr)).str("\n");
+        out.flush();  // in case walking the stack faults
+
+        size_t depth = 0;
+        uintptr_t pc = 0;
+        void* fp = nullptr;
+        if (detail::interruptedAt(ucontext, &pc, &fp)) {
+            frames_[depth++] = (void const*) pc;  // the faulting instruction itself
+            depth += detail::walkStack(fp, frames_ + depth, StackTrace::kMaxDepth - depth);
+        } else {
+            depth = detail::walkStack(__builtin_frame_address(0), frames_, StackTrace::kMaxDepth);
+        }
+        for (size_t i = 0; i < depth; i++) {
+            out.str("frame ").hex(uintptr_t(frames_[i])).str("\n");
+        }
+
+        auto const& modules = ModuleMap::get().modules();
+        for (size_t i = 0; i < depth; i++) {
+            auto const* mod = moduleAt(modules, uintptr_t(frames_[i]));
+            bool seen = false;
+            for (size_t j = 0; j < i && !seen; j++) {
+                seen = (moduleAt(modules, uintptr_t(frames_[j])) == mod);
+            }
+            if (!mod || seen) { continue; }
+            out.str("module ").hex(mod->begin).str(" ").hex(mod->end).str(" ");
+            out.str(mod->path.data(), mod->path.size()).str("\n");
+        }
+        out.str("*** end\n");
+    }
+
+    /**
+     * Read a trace written by the crash handler, as unresolved frames with their binaries and
+     * load bases filled in; `resolve` them (in any process) to name functions and source lines.
+     */
+    static std::vector<Ref<StackFrame>> read(std::istream& in) {
+        std::vector<Ref<StackFrame>> ret;
+        std::vector<Module> modules;
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            std::string kind;
+            uintptr_t addr = 0;
+            fields >> kind >> std::hex >> addr;
+            if (kind == "frame") {
+                auto sf = Ref<StackFrame>::make();
+                sf->address = (void const*) addr;
+                ret.push_back(std::move(sf));
+            } else if (kind == "module") {
+                Module mod {addr, 0, 0, {}};
+                fields >> mod.end;
+                fields.ignore(1);
+                std::getline(fields, mod.path);
+                modules.push_back(std::move(mod));
+            }
+        }
+
+        for (size_t i = 0; i < ret.size(); i++) {
+            // A frame in no module (e.g. a bad return address) isn't looked up in this process's
+            auto const* found = moduleAt(modules, uintptr_t(ret[i]->address));
+            ret[i]->filename = found ? found->path : "?";
+            ret[i]->loadBase = found ? found->begin : 0;
+            if (i + 1 < ret.size()) { ret[i]->next = ret[i + 1]; }
+        }
+        return ret;
+    }
+};
+
+}  // namespace cxx
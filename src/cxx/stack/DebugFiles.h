@@ -0,0 +1,143 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "../prog/ObjectFile.h"
+#include "../ref/Ref.h"
+#include "Cache.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cxx {
+
+namespace detail {
+
+/** CRC-32 (the zlib / `.gnu_debuglink` one: reflected, polynomial 0xEDB88320) of `size` bytes. */
+inline uint32_t crc32(uint8_t const* data, size_t size, uint32_t crc = 0) {
+    static auto const table = [] {
+        std::array<uint32_t, 256> ret;
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) { c = (c & 1) ? (0xedb88320 ^ (c >> 1)) : (c >> 1); }
+            ret[i] = c;
+        }
+        return ret;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) { crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8); }
+    return ~crc;
+}
+
+}  // namespace detail
+
+/**
+ * Finds the separate debug info files of a binary: e.g. a program shipped stripped, with its
+ * debug info in a package installed under `/usr/lib/debug`.  As GDB does, it looks:
+ *
+ * - by build ID: `<dir>/.build-id/ab/cdef0123[...].debug`, under each debug directory; only
+ *   taken if it has that build ID too (not, say, a stale file from an earlier package);
+ * - by `.gnu_debuglink`: for the named file beside the binary, in `.debug/` beside it, then
+ *   under each debug directory (as `<dir>/path/of/binary's/dir/name`); only taken if its CRC-32
+ *   matches the link's.
+ *
+ * (Split DWARF, in `.dwo` and `.dwp` files, is found per unit when reading debug info; see
+ * `SplitDWARF`.)  Candidates which aren't binaries at all (empty placeholders, directories,
+ * truncated downloads) are skipped.  Files are opened through `BinaryCache`, and the results are
+ * kept by build ID where there is one, so a binary reached through several paths is only
+ * searched for once.
+ */
+class DebugFiles final {
+    std::mutex mutex_;
+    std::vector<std::string> dirs_ {"/usr/lib/debug"};
+    std::unordered_map<std::string, std::vector<Ref<Binary>>> byBuildID_;
+
+    static std::string dirOf(std::string const& path) {
+        auto slash = path.rfind('/');
+        return (slash == std::string::npos) ? "." : path.substr(0, slash);
+    }
+
+    static bool exists(std::string const& path) { return ::access(path.data(), R_OK) == 0; }
+
+    std::vector<Ref<Binary>> search(Binary const& binary, std::string const& buildID) const {
+        auto& cache = BinaryCache::get();
+        auto const& path = binary.file_->path_;
+        auto open = [&](std::string const& candidate) -> Ref<Binary> {
+            if (candidate == path || !exists(candidate)) { return {}; }
+            return cache.open(candidate, binary.vmaSlide_);
+        };
+
+        std::vector<Ref<Binary>> ret;
+        if (buildID.size() > 2) {
+            for (auto const& dir : dirs_) {
+                auto name = dir + "/.build-id/" + buildID.substr(0, 2) + "/" + buildID.substr(2);
+                auto found = open(name + ".debug");
+                if (found && found->buildID() == buildID) {
+                    ret.push_back(std::move(found));
+                    return ret;
+                }
+            }
+        }
+
+        if (auto link = binary.debugLink()) {
+            auto dir = dirOf(path);
+            std::vector<std::string> candidates {dir + "/" + link->file,
+                                                 dir + "/.debug/" + link->file};
+            for (auto const& debugDir : dirs_) {
+                candidates.push_back(debugDir + dir + "/" + link->file);
+            }
+            for (auto const& candidate : candidates) {
+                auto found = open(candidate);
+                if (!found) { continue; }
+                auto bytes = found->file_->cur();
+                if (detail::crc32(bytes.base_, bytes.size_) == link->crc) {
+                    ret.push_back(std::move(found));
+                    break;
+                }
+            }
+        }
+        return ret;
+    }
+
+public:
+    static DebugFiles& get() {
+        // Never destroyed, since stack traces might still be resolved during static destruction
+        static auto* ret = new DebugFiles();
+        return *ret;
+    }
+
+    /** Where to look for debug files by build ID or debug link; default: `/usr/lib/debug`. */
+    std::vector<std::string> dirs() {
+        std::lock_guard lock(mutex_);
+        return dirs_;
+    }
+
+    /** Replace the debug directories.  Affects binaries not yet searched for. */
+    void setDirs(std::vector<std::string> dirs) {
+        std::lock_guard lock(mutex_);
+        dirs_ = std::move(dirs);
+        byBuildID_.clear();
+    }
+
+    /** Separate debug files for `binary` (usually one, or none).  See `Binary::debugFiles`. */
+    std::vector<Ref<Binary>> find(Binary const& binary) {
+        auto buildID = binary.buildID();
+        std::lock_guard lock(mutex_);
+        if (!buildID.empty()) {
+            auto it = byBuildID_.find(buildID);
+            if (it != byBuildID_.end()) { return it->second; }
+        }
+        auto ret = search(binary, buildID);
+        if (!buildID.empty()) { byBuildID_[buildID] = ret; }
+        return ret;
+    }
+};
+
+}  // namespace cxx
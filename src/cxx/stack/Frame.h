@@ -8,6 +8,7 @@ static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 
 #include <cerrno>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <cxxabi.h>
@@ -25,12 +26,15 @@ namespace cxx {
 
 struct StackFrame final {
     void const* address {nullptr};
-    Ref<StackFrame> next {};
+    Ref<StackFrame> mutable next {};  // `resolve` may insert frames for inlined calls
     // All these are mutable and only filled in when `resolve` is called,
     // so `resolve` can be used within a `catch (cxx::Exception const& ...)`
+    bool mutable inlined {false};  // this function's code was inlined into the next frame's
+    bool mutable caller {false};   // added by `resolve`: a function the previous was inlined into
     std::string mutable symbol {};
     std::string mutable demangled {};
     std::string mutable filename {};
+    uintptr_t mutable loadBase {0};  // where the binary `filename` was loaded
     SourceLoc mutable loc {};
 
     std::string sym() const { return (!demangled.empty() ? demangled : symbol); }
@@ -0,0 +1,170 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <dlfcn.h>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace cxx {
+
+namespace detail {
+
+/**
+ * `dl_iterate_phdr` (ELF platforms), looked up when first used, like `DYLD`; there's no such
+ * function on OSX, where this finds nothing.  The structs mirror `<link.h>`'s `dl_phdr_info`
+ * and `Elf64_Phdr`, for 64-bit targets.
+ */
+struct DLIteratePhdr final {
+    struct Phdr final {
+        uint32_t type;
+        uint32_t flags;
+        uint64_t offset;
+        uint64_t vaddr;
+        uint64_t paddr;
+        uint64_t filesz;
+        uint64_t memsz;
+        uint64_t align;
+    };
+
+    struct Info final {
+        uintptr_t addr;  // load bias
+        char const* name;
+        Phdr const* phdr;
+        uint16_t phnum;
+        // Only if the callback's `size` says so (glibc 2.4 and later):
+        unsigned long long adds;  // objects ever loaded
+        unsigned long long subs;  // objects ever unloaded
+    };
+
+    using Callback = int (*)(Info*, size_t, void*);
+
+    int operator()(Callback callback, void* data) {
+        static auto* func = (int (*)(Callback, void*)) dlsym(RTLD_DEFAULT, "dl_iterate_phdr");
+        return func ? func(callback, data) : 0;
+    }
+};
+
+}  // namespace detail
+
+/** A loaded program or shared library. */
+struct Module final {
+    uintptr_t begin;  // lowest address of any of its loaded segments
+    uintptr_t end;    // just past the highest
+    uintptr_t bias;   // load bias: the difference between runtime and file (virtual) addresses
+    std::string path;
+};
+
+/**
+ * Address ranges of the loaded program and shared libraries, from `dl_iterate_phdr`, to find
+ * the object an address is in without `dladdr` (which takes the loader's lock, every time).
+ *
+ * Like `BinaryCache`, lookups are lock-free, on an immutable snapshot sorted by address.
+ * A lookup which misses checks whether objects were loaded or unloaded (`dlopen`, `dlclose`)
+ * since the snapshot was taken, and if so, refreshes it and tries again.  That check walks the
+ * loader's list (under its lock), so misses (e.g. for JIT code, or bad return addresses) make
+ * it at most once per `kRecheckInterval`; one which doesn't is just a miss, and the caller
+ * falls back to `dladdr`.  Superseded snapshots are kept, as a reader might still be using one.
+ */
+class ModuleMap final {
+public:
+    constexpr static std::chrono::milliseconds kRecheckInterval {10};
+
+private:
+    using Modules = std::vector<Module>;
+    using Clock = std::chrono::steady_clock;
+
+    std::atomic<Modules const*> modules_ {new Modules()};
+    std::atomic<uint64_t> generation_ {UINT64_MAX};  // `adds + subs` as of that snapshot
+    std::atomic<Clock::rep> lastCheck_ {0};          // when a miss last checked `generation_`
+    std::mutex mutex_;                 // held while refreshing
+    std::vector<Modules const*> old_;  // superseded snapshots; see above
+
+    static Module const* find(Modules const& modules, uintptr_t addr) {
+        auto it = std::ranges::upper_bound(modules, addr, {}, &Module::begin);
+        if (it == modules.begin() || addr >= (--it)->end) { return nullptr; }
+        return &*it;
+    }
+
+    /** Current load/unload count, or 0 if the platform doesn't say. */
+    static uint64_t currentGeneration() {
+        uint64_t ret = 0;
+        detail::DLIteratePhdr()(
+                [](detail::DLIteratePhdr::Info* info, size_t size, void* data) {
+                    if (size >= sizeof(detail::DLIteratePhdr::Info)) {
+                        *(uint64_t*) data = info->adds + info->subs;
+                    }
+                    return 1;  // only need the first
+                },
+                &ret);
+        return ret;
+    }
+
+    static std::string selfPath() {
+        char buf[4096];
+        auto len = readlink("/proc/self/exe", buf, sizeof(buf));
+        return (len > 0 && size_t(len) < sizeof(buf)) ? std::string(buf, len) : "";
+    }
+
+public:
+    static ModuleMap& get() {
+        // Never destroyed, since stack traces might still be resolved during static destruction
+        static auto* ret = new ModuleMap();
+        return *ret;
+    }
+
+    /** Modules as of the last refresh, sorted by address. */
+    Modules const& modules() const { return *modules_.load(std::memory_order_acquire); }
+
+    /** Re-read the list of loaded objects; done automatically as needed (see above). */
+    void refresh() {
+        constexpr static uint32_t kLoad = 1;  // PT_LOAD
+
+        std::lock_guard lock(mutex_);
+        auto generation = currentGeneration();
+        auto* next = new Modules();
+        detail::DLIteratePhdr()(
+                [](detail::DLIteratePhdr::Info* info, size_t, void* data) {
+                    Module mod {UINTPTR_MAX, 0, info->addr, info->name ? info->name : ""};
+                    for (size_t i = 0; i < info->phnum; i++) {
+                        auto const& ph = info->phdr[i];
+                        if (ph.type != kLoad) { continue; }
+                        auto vaddr = ph.vaddr;
+                        if (ph.align > 1) { vaddr &= ~(ph.align - 1); }
+                        mod.begin = std::min(mod.begin, uintptr_t(info->addr + vaddr));
+                        mod.end = std::max(mod.end, uintptr_t(info->addr + ph.vaddr + ph.memsz));
+                    }
+                    // The main program comes first, with an empty name
+                    auto* modules = (Modules*) data;
+                    if (modules->empty() && mod.path.empty()) { mod.path = selfPath(); }
+                    if (mod.begin < mod.end) { modules->push_back(std::move(mod)); }
+                    return 0;
+                },
+                next);
+        std::ranges::sort(*next, {}, &Module::begin);
+        old_.push_back(modules_.exchange(next, std::memory_order_acq_rel));
+        generation_.store(generation, std::memory_order_release);
+    }
+
+    /** The module containing `addr`, or nullptr if none (or not known yet; see above). */
+    Module const* find(uintptr_t addr) {
+        if (auto const* ret = find(*modules_.load(std::memory_order_acquire), addr)) { return ret; }
+        auto now = Clock::now().time_since_epoch().count();
+        auto last = lastCheck_.load(std::memory_order_relaxed);
+        auto interval = std::chrono::duration_cast<Clock::duration>(kRecheckInterval).count();
+        if (last && now - last < interval) { return nullptr; }
+        if (!lastCheck_.compare_exchange_strong(last, now)) { return nullptr; }  // another did
+        if (generation_.load(std::memory_order_acquire) == currentGeneration()) { return nullptr; }
+        refresh();
+        return find(*modules_.load(std::memory_order_acquire), addr);
+    }
+};
+
+}  // namespace cxx
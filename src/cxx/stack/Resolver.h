@@ -2,13 +2,13 @@
 static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 // (c) 2024 Steve O'Brien -- MIT License
 
+#include "../prog/FunctionIndex.h"
 #include "../prog/ObjectFile.h"
 #include "../prog/SourceLoc.h"
 
 #include <cstddef>
 #include <cstdint>
 #include <dlfcn.h>
-#include <map>
 #include <string>
 #include <vector>
 
@@ -37,11 +37,15 @@ struct DYLD final {
 
 }  // namespace detail
 
+/**
+ * Finds binaries and source locations for stack frames.  This is cheap to create: binaries
+ * and their decoded line tables live in the process-wide `BinaryCache`, so are only opened and
+ * decoded once, no matter how many resolvers (or threads) look things up in them.
+ */
 struct StackResolver final {
-    std::map<uintptr_t, SourceLoc> locs;
     uintptr_t vmaSlide;  // for main program image only
 
-    // Contains the program itself, extra DWARF debug files, shared libs, ...
+    // Contains the program itself, extra DWARF debug files, shared libs, ... (no duplicates)
     std::vector<Ref<Binary>> binaries;
 
     StackResolver() {
@@ -49,9 +53,36 @@ struct StackResolver final {
         vmaSlide = dyld.getImageVMAddrSlide(0);
     }
 
+    /** Open `thisProg` (and any debug-info companions). */
     void findBinaries(std::string const& thisProg);
+
+    /** Binaries opened (by `findBinaries`) for `filename`: the file, its separate debug files
+     * (see `DebugFiles`), and its `.dSYM` if any. */
+    std::vector<Binary const*> binariesOf(std::string const& filename) const;
+
+    /** The binary opened for `filename`, if it has a `SymbolIndex` (which lookups then use). */
+    Binary const* indexedBinaryOf(std::string const& filename) const;
+
+    /** Slide of `filename` (and its debug files) when loaded at `loadBase`; with no `loadBase`,
+     * as opened.  See `Binary::slideAt`. */
+    uint64_t slideOf(std::string const& filename, uintptr_t loadBase) const;
+
+    // Lookups by runtime address `addr`.  Those in `filename` take where it's loaded (e.g.
+    // `StackFrame::loadBase`), since that can differ between processes, or loads of it.
+
     SourceLoc findLocation(uintptr_t addr, Binary const& binary);
+    SourceLoc findLocation(uintptr_t addr, std::string const& filename, uintptr_t loadBase = 0);
     SourceLoc findLocation(uintptr_t addr);
+
+    /** Name of the symbol covering `addr` in `filename`, or nullptr. */
+    char const* findSymbol(uintptr_t addr, std::string const& filename, uintptr_t loadBase = 0);
+
+    /** Function at `addr`, preceded by any inlined into it there; see `FunctionIndex::find`. */
+    std::vector<FunctionIndex::Scope> findFunctions(uintptr_t addr, std::string const& filename,
+                                                    uintptr_t loadBase = 0);
+
+    /** Source location of (unslid) address `vaddr` in `binary`'s line tables. */
+    static SourceLoc lineAt(uint64_t vaddr, Binary const& binary);
 };
 
 }  // namespace cxx
@@ -0,0 +1,68 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "../prog/ObjectFile.h"
+#include "../prog/SymbolIndex.h"
+#include "../ref/Ref.h"
+
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cxx {
+
+/**
+ * Where `SymbolIndex` files are kept: `<dir>/<build ID>.symidx`.  Off by default; once a
+ * directory is set, the first process to resolve a frame in some build decodes all of that
+ * binary's debug info (and its separate debug files') once, and writes its index there; later
+ * processes (and other binaries with the same build ID) just map it.
+ *
+ * The directory must exist, and be writable by whoever should create indexes; binaries with no
+ * build ID aren't indexed, since an index couldn't be told apart from one for another build.
+ */
+class SymbolIndexCache final {
+    std::mutex mutex_;
+    std::string dir_;
+
+public:
+    static SymbolIndexCache& get() {
+        // Never destroyed, since stack traces might still be resolved during static destruction
+        static auto* ret = new SymbolIndexCache();
+        return *ret;
+    }
+
+    /** Directory of index files; empty (the default) if disabled. */
+    std::string dir() {
+        std::lock_guard lock(mutex_);
+        return dir_;
+    }
+
+    /** Set (or with "", clear) the index directory.  Affects binaries not yet looked up in. */
+    void setDir(std::string dir) {
+        std::lock_guard lock(mutex_);
+        dir_ = std::move(dir);
+    }
+
+    /** The index for `binary`, written first if there isn't one; empty if none can be had. */
+    Ref<SymbolIndex> open(Binary const& binary) {
+        auto dir = this->dir();
+        if (dir.empty()) { return {}; }
+        auto buildID = binary.buildID();
+        if (buildID.empty()) { return {}; }
+        auto path = dir + "/" + buildID + ".symidx";
+        if (auto ret = SymbolIndex::load(path, buildID)) { return ret; }
+
+        std::vector<Binary const*> sources;
+        for (auto const& debug : binary.debugFiles()) { sources.push_back(debug.get()); }
+        sources.push_back(&binary);
+        if (!SymbolIndex::write(path, buildID, sources)) {
+            std::cerr << "cannot write symbol index: " << path << '\n';
+            return {};
+        }
+        return SymbolIndex::load(path, buildID);
+    }
+};
+
+}  // namespace cxx
@@ -6,15 +6,49 @@ static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
 #include "Frame.h"
 #include "Resolver.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <cxxabi.h>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <string>
 
 namespace cxx {
 
+namespace detail {
+
+/**
+ * Walk the chain of frame pointers from `framePtr`, writing the return addresses found there
+ * (each backed up by one byte, into the call instruction) to `out`; returns how many.  Only reads
+ * memory, so is async-signal-safe (see `CrashHandler`).
+ */
+inline size_t walkStack(void* framePtr, void const** out, size_t max) noexcept {
+    // Larger than any sane frame; default thread stacks are only around 8MB in total
+    constexpr static uintptr_t kMaxFrameSize = uintptr_t(1) << 24;
+
+    size_t depth = 0;
+    auto** ptr = (void**) framePtr;                 // Starting at this frame,
+    while (ptr && depth < max) {                    // until we hit the end or the limit...:
+        auto ipNext = ((uintptr_t) (ptr[1]));       // find IP of instruction after call
+        if (!ipNext) { break; }                     // (if no return address, we're at end).
+        out[depth++] = (void const*) (ipNext - 1);  // Back up to last byte of prev insn.
+        auto** next = (void**) ptr[0];              // Continue walking the stack.
+
+        // Callers' frames are further up the stack, aligned, and not absurdly far away.
+        // Anything else means we've reached code built without frame pointers (e.g. libc),
+        // where this slot holds some unrelated value; stop rather than dereference it.
+        auto delta = uintptr_t(next) - uintptr_t(ptr);
+        if (next <= ptr || delta > kMaxFrameSize || uintptr_t(next) % alignof(void*)) { break; }
+        ptr = next;
+    }
+    return depth;
+}
+
+}  // namespace detail
+
 std::string demangle(char const* name) {
     int st = 0;
     auto* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &st);
@@ -27,28 +61,90 @@ std::string demangle(char const* name) {
 /**
  * Similar to the standard C++23 `std::stacktrace`, but differs in several ways.
  * TODO: drop this when `std::stacktrace` is available in libcxx.
+ *
+ * Construction only records raw return addresses, into a fixed-size array inside this object,
+ * so capturing a trace (e.g. on every `cxx::Exception`) never allocates.  The `StackFrame`s
+ * with their symbols and source locations are only built when iterated, resolved, or dumped.
+ *
+ * `resolve` and `dump` may be called from several threads at once.  Iterating the frames may
+ * not, while another thread resolves: resolving inserts frames (for inlined calls) into the
+ * list.  Copies build (and resolve) their own frames, so are independent of each other.
  */
 
 struct StackTrace final {
     // clang-format off
-    Ref<StackFrame> frame {};
-    StackTrace();
+    /** Capacity of the address array; frames beyond this many (nearest `main`) are dropped. */
+    constexpr static size_t kMaxDepth = 64;
+
+    void const* addrs_[kMaxDepth];
+    size_t depth_ {0};
+    std::mutex mutable framesMutex_;   // a trace may be shared across threads (e.g. in an exception)
+    Ref<StackFrame> mutable frame {};  // built from `addrs_` on demand; see `frames()`
+
+private:
+    /** Build the frames if not yet built; `framesMutex_` must be held. */
+    StackFrame* head() const {
+        if (frame || !depth_) { return frame.get(); }
+        auto* nextFramePtr = &frame;
+        for (size_t i = 0; i < depth_; i++) {
+            auto sf = Ref<StackFrame>::make();
+            sf->address = addrs_[i];
+            *nextFramePtr = sf;
+            nextFramePtr = &sf->next;
+        }
+        return frame.get();
+    }
+
+public:
+    /** Capture the current stack, recording at most `maxDepth` (capped at `kMaxDepth`) frames. */
+    explicit StackTrace(size_t maxDepth = kMaxDepth) noexcept;
+
+    /** Capture from the caller of the function whose frame is `framePtr` (leaving it out). */
+    StackTrace(size_t maxDepth, void* framePtr) noexcept;
+
+    /** Copies only the addresses; a copy's frames are its own (see above). */
+    StackTrace(StackTrace const& rhs) : depth_(rhs.depth_) {
+        std::copy_n(rhs.addrs_, depth_, addrs_);
+    }
+
+    StackTrace& operator=(StackTrace const& rhs) {
+        if (this == &rhs) { return *this; }
+        std::lock_guard lock(framesMutex_);
+        depth_ = rhs.depth_;
+        std::copy_n(rhs.addrs_, depth_, addrs_);
+        frame = nullptr;
+        return *this;
+    }
+
+    size_t size() const { return depth_; }
+    void const* address(size_t i) const { return addrs_[i]; }
+
+    /** Head of the list of frames; these are created (unresolved) upon the first call. */
+    Ref<StackFrame> const& frames() const {
+        std::lock_guard lock(framesMutex_);
+        head();
+        return frame;
+    }
 
     using value_type = StackFrame;
     using iterator = StackFrameIterator;
-    iterator begin() const { return {frame.get()}; }
+    iterator begin() const { return {frames().get()}; }
     iterator end() const { return {nullptr}; }
 
-    void resolve(StackResolver& sr) const { for (auto* sf : *this) { sf->resolve(sr); } }
- 
+    void resolve(StackResolver& sr) const {
+        std::lock_guard lock(framesMutex_);
+        for (iterator it {head()}; it != end(); ++it) { (*it)->resolve(sr); }
+    }
+
     void dump(std::ostream& os) const {
         // These lines can unfortunately get rather long, so we take care to
         // trim some crap: shorten the filenames, but add only enough padding to make
         // things line up nicely.  See also the `loc()` method
+        std::lock_guard lock(framesMutex_);  // not while another thread resolves
         auto end = this->end();
-        auto it = this->begin();
+        iterator it {head()};
         // If first entry is for `cxx::StackTrace::StackTrace()`, discard
-        if (it != end && (*it)->symbol == "_ZN3cxx10StackTraceC1Ev") { ++it; }
+        if (it != end && (*it)->symbol.starts_with("_ZN3cxx10StackTraceC")) { ++it; }
         auto begin = it;
         int width = 15;  // minimum width; arbitrary
         auto adjust = [&width] (int w) { width = (w > width) ? w : width; };
@@ -59,7 +155,7 @@ struct StackTrace final {
             auto& sf = **it;
             os << "... 0x" << std::setw(12) << std::setfill('0') << std::hex << uint64_t(sf.address)
             << ' ' << std::setw(width) << std::setfill(' ') << sf.locStr()
-            << ' ' << std::setw(0) << sf.sym() << std::endl;
+            << ' ' << std::setw(0) << sf.sym() << (sf.inlined ? " [inlined]" : "") << std::endl;
             ++it;
         }
     }
@@ -0,0 +1,388 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include "../gen/Generator.h"
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <utility>
+
+namespace cxx {
+
+/**
+ * A bounded, multi-producer / multi-consumer queue for passing values (e.g. `Ref`s) between
+ * threads and coroutines.
+ *
+ * The queue itself is Dmitry Vyukov's bounded MPMC ring: each cell carries a sequence number
+ * telling producers and consumers whether it's theirs to fill or empty, so `trySend` and
+ * `tryRecv` are lock-free.  On top of that are:
+ *
+ * - `send` / `recv`, which block the calling thread (`std::atomic::wait`) when full / empty;
+ * - `asyncSend` / `asyncRecv`, to `co_await` from a coroutine, suspending it instead.  A suspended
+ *   coroutine is resumed by whichever thread next makes room or provides a value (or closes);
+ * - `close`: afterwards, sends fail and receivers get the remaining values, then nothing.
+ *
+ * Channels are neither copyable nor movable; share one with e.g. `Ref<Channel<T>>`.
+ */
+template <typename T>
+class Channel final {
+    constexpr static uint64_t kClosed = uint64_t(1) << 63;  // flag bit on `enqueuePos_`
+    constexpr static int kSpins = 64;                        // before blocking a thread
+
+    struct Cell final {
+        std::atomic<uint64_t> seq_;
+        std::optional<T> val_ {};
+    };
+
+public:
+    struct SendAwaiter;
+    struct RecvAwaiter;
+
+private:
+    // Coroutines suspended in `asyncSend` / `asyncRecv`; intrusive FIFO list, guarded by `mutex`.
+    template <typename W>
+    struct Parked final {
+        std::mutex mutex_;
+        W* head_ {nullptr};
+        W* tail_ {nullptr};
+        std::atomic<uint64_t> count_ {0};
+
+        void push(W* w) {
+            w->next_ = nullptr;
+            (tail_ ? tail_->next_ : head_) = w;
+            tail_ = w;
+        }
+
+        W* pop() {
+            auto* ret = head_;
+            head_ = ret->next_;
+            if (!head_) { tail_ = nullptr; }
+            count_.fetch_sub(1);
+            return ret;
+        }
+    };
+
+    uint64_t const mask_;
+    std::unique_ptr<Cell[]> cells_;
+    // Spread the hot counters across cache lines (padding, since we can't rely on `alignas`
+    // being honored wherever this is allocated).
+    char pad0_[64] {};
+    std::atomic<uint64_t> enqueuePos_ {0};  // next cell to fill; also has the `kClosed` bit
+    char pad1_[64] {};
+    std::atomic<uint64_t> dequeuePos_ {0};  // next cell to empty
+    char pad2_[64] {};
+    std::atomic<uint64_t> sent_ {0};      // bumped after a value is stored, or on close
+    std::atomic<uint64_t> received_ {0};  // bumped after a value is taken, or on close
+    std::atomic<uint64_t> blockedSend_ {0};
+    std::atomic<uint64_t> blockedRecv_ {0};
+    Parked<SendAwaiter> parkedSend_;
+    Parked<RecvAwaiter> parkedRecv_;
+
+    static uint64_t roundUp(size_t capacity) {
+        uint64_t ret = 2;  // the algorithm needs at least two cells
+        while (ret < capacity) { ret <<= 1; }
+        return ret;
+    }
+
+    bool trySendImpl(T&& val) {
+        auto pos = enqueuePos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            if (pos & kClosed) { return false; }
+            cell = &cells_[pos & mask_];
+            auto seq = cell->seq_.load(std::memory_order_acquire);
+            auto diff = int64_t(seq) - int64_t(pos);
+            if (diff == 0) {  // cell is free to fill; try to claim it
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {  // still holds the value from one lap ago: full
+                return false;
+            } else {  // another producer got here first
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->val_.emplace(std::move(val));
+        cell->seq_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::optional<T> tryRecvImpl() {
+        auto pos = dequeuePos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            auto seq = cell->seq_.load(std::memory_order_acquire);
+            auto diff = int64_t(seq) - int64_t(pos + 1);
+            if (diff == 0) {  // cell has a value; try to claim it
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {  // not filled (yet): empty
+                return {};
+            } else {  // another consumer got here first
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        std::optional<T> ret = std::move(cell->val_);
+        cell->val_.reset();
+        cell->seq_.store(pos + mask_ + 1, std::memory_order_release);
+        return ret;
+    }
+
+    // After a successful op: wake a blocked thread on the other side, if any.
+    void signalSent() {
+        sent_.fetch_add(1);
+        if (blockedRecv_.load()) { sent_.notify_one(); }
+    }
+
+    void signalReceived() {
+        received_.fetch_add(1);
+        if (blockedSend_.load()) { received_.notify_one(); }
+    }
+
+    // After a successful op: complete as many suspended coroutines as we can.
+    void serviceParked() {
+        if (!parkedSend_.count_.load() && !parkedRecv_.count_.load()) { return; }
+        SendAwaiter* sendDone = nullptr;
+        RecvAwaiter* recvDone = nullptr;
+        bool progress = true;
+        while (progress) {  // completing a receive can allow a send, and vice versa
+            progress = false;
+            {
+                std::lock_guard lock(parkedRecv_.mutex_);
+                while (parkedRecv_.head_) {
+                    auto val = tryRecvImpl();
+                    if (val) {
+                        parkedRecv_.head_->val_ = std::move(val);
+                        signalReceived();
+                    } else if (!drained()) {
+                        break;
+                    }
+                    auto* w = parkedRecv_.pop();
+                    w->next_ = recvDone;
+                    recvDone = w;
+                    progress = true;
+                }
+            }
+            {
+                std::lock_guard lock(parkedSend_.mutex_);
+                while (parkedSend_.head_) {
+                    auto* head = parkedSend_.head_;
+                    if (trySendImpl(std::move(head->val_))) {
+                        head->ok_ = true;
+                        signalSent();
+                    } else if (!closed()) {
+                        break;
+                    }
+                    auto* w = parkedSend_.pop();
+                    w->next_ = sendDone;
+                    sendDone = w;
+                    progress = true;
+                }
+            }
+        }
+        // Resume outside of the locks.  Awaiters live in their coroutine frames,
+        // so grab `next_` before each resume.
+        while (recvDone) { std::exchange(recvDone, recvDone->next_)->handle_.resume(); }
+        while (sendDone) { std::exchange(sendDone, sendDone->next_)->handle_.resume(); }
+    }
+
+    bool parkSend(SendAwaiter* w) {
+        std::unique_lock lock(parkedSend_.mutex_);
+        parkedSend_.count_.fetch_add(1);
+        (void) received_.load();  // pairs with `signalReceived` + `serviceParked`
+        if (trySendImpl(std::move(w->val_))) {
+            w->ok_ = true;
+        } else if (!closed()) {
+            parkedSend_.push(w);
+            return true;  // don't touch `w` after unlocking; it may already be resumed
+        }
+        parkedSend_.count_.fetch_sub(1);
+        lock.unlock();
+        if (w->ok_) { afterSend(); }
+        return false;
+    }
+
+    bool parkRecv(RecvAwaiter* w) {
+        std::unique_lock lock(parkedRecv_.mutex_);
+        parkedRecv_.count_.fetch_add(1);
+        (void) sent_.load();  // pairs with `signalSent` + `serviceParked`
+        w->val_ = tryRecvImpl();
+        if (!w->val_ && !drained()) {
+            parkedRecv_.push(w);
+            return true;  // as above
+        }
+        parkedRecv_.count_.fetch_sub(1);
+        lock.unlock();
+        if (w->val_) { afterRecv(); }
+        return false;
+    }
+
+    void afterSend() {
+        signalSent();
+        serviceParked();
+    }
+
+    void afterRecv() {
+        signalReceived();
+        serviceParked();
+    }
+
+public:
+    ~Channel() = default;
+    Channel(Channel const&) = delete;
+    Channel& operator=(Channel const&) = delete;
+
+    /** Holds (at least) `capacity` values; rounded up to a power of two. */
+    explicit Channel(size_t capacity)
+            : mask_(roundUp(capacity) - 1)
+            , cells_(new Cell[mask_ + 1]) {
+        for (uint64_t i = 0; i <= mask_; i++) { cells_[i].seq_.store(i, std::memory_order_relaxed); }
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+    bool closed() const { return enqueuePos_.load() & kClosed; }
+
+    /** Closed, and every value sent has been (or is being) received. */
+    bool drained() const {
+        auto enq = enqueuePos_.load();
+        return (enq & kClosed) && dequeuePos_.load() >= (enq & ~kClosed);
+    }
+
+    /**
+     * Further sends will fail; receivers get what's still buffered, then empty results.
+     * Wakes all blocked threads and suspended coroutines that can no longer succeed.
+     */
+    void close() {
+        enqueuePos_.fetch_or(kClosed);
+        sent_.fetch_add(1);
+        received_.fetch_add(1);
+        sent_.notify_all();
+        received_.notify_all();
+        serviceParked();
+    }
+
+    /** Send without waiting.  `val` is moved from only if this succeeds (not full, not closed). */
+    bool trySend(T&& val) {
+        if (!trySendImpl(std::move(val))) { return false; }
+        afterSend();
+        return true;
+    }
+
+    bool trySend(T const& val) { return trySend(T(val)); }
+
+    /** Receive without waiting.  Empty if there's nothing buffered right now. */
+    std::optional<T> tryRecv() {
+        auto ret = tryRecvImpl();
+        if (ret) { afterRecv(); }
+        return ret;
+    }
+
+    /** Send, blocking this thread while the channel is full.  False if the channel was closed. */
+    bool send(T val) {
+        while (true) {
+            for (int i = 0; i < kSpins; i++) {
+                if (trySend(std::move(val))) { return true; }
+                if (closed()) { return false; }
+            }
+            blockedSend_.fetch_add(1);
+            auto seen = received_.load();
+            bool ok = trySend(std::move(val));  // recheck now that we're registered
+            if (!ok && !closed()) { received_.wait(seen); }
+            blockedSend_.fetch_sub(1);
+            if (ok) { return true; }
+            if (closed()) { return false; }
+        }
+    }
+
+    /** Receive, blocking this thread while the channel is empty.  Empty once drained. */
+    std::optional<T> recv() {
+        while (true) {
+            for (int i = 0; i < kSpins; i++) {
+                if (auto ret = tryRecv()) { return ret; }
+                if (drained()) { return {}; }
+            }
+            blockedRecv_.fetch_add(1);
+            auto seen = sent_.load();
+            auto ret = tryRecv();  // recheck now that we're registered
+            if (!ret && !drained()) { sent_.wait(seen); }
+            blockedRecv_.fetch_sub(1);
+            if (ret) { return ret; }
+            if (drained()) { return {}; }
+        }
+    }
+
+    /** `co_await ch.asyncSend(val)`: suspends while full; result is false if closed. */
+    struct SendAwaiter final {
+        Channel& ch_;
+        T val_;
+        bool ok_ {false};
+        std::coroutine_handle<> handle_ {};
+        SendAwaiter* next_ {nullptr};
+
+        bool await_ready() {
+            ok_ = ch_.trySend(std::move(val_));
+            return ok_ || ch_.closed();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            return ch_.parkSend(this);
+        }
+
+        bool await_resume() const noexcept { return ok_; }
+    };
+
+    /** `co_await ch.asyncRecv()`: suspends while empty; result is empty once drained. */
+    struct RecvAwaiter final {
+        Channel& ch_;
+        std::optional<T> val_ {};
+        std::coroutine_handle<> handle_ {};
+        RecvAwaiter* next_ {nullptr};
+
+        bool await_ready() {
+            val_ = ch_.tryRecv();
+            return val_ || ch_.drained();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            return ch_.parkRecv(this);
+        }
+
+        std::optional<T> await_resume() noexcept { return std::move(val_); }
+    };
+
+    SendAwaiter asyncSend(T val) { return {*this, std::move(val)}; }
+    RecvAwaiter asyncRecv() { return {*this}; }
+
+    /** Receive (blocking) until the channel is closed and drained. */
+    Generator<T> recvAll() {
+        while (auto val = recv()) { co_yield std::move(*val); }
+    }
+
+    /**
+     * Send (blocking) everything from `source`, e.g. a `Generator`; stops early if the channel
+     * is closed.  Doesn't close the channel itself.  Returns the number of values sent.
+     */
+    template <std::ranges::input_range S>
+    size_t sendAll(S&& source) {
+        size_t ret = 0;
+        auto end = std::ranges::end(source);
+        for (auto it = std::ranges::begin(source); it != end; ++it, ++ret) {
+            if (!send(std::ranges::iter_move(it))) { break; }
+        }
+        return ret;
+    }
+};
+
+}  // namespace cxx
@@ -0,0 +1,83 @@
+#pragma once
+static_assert(__cplusplus >= 202300L, "cxx-libs requires C++23");
+// (c) 2024 Steve O'Brien -- MIT License
+
+#include <cxx/Exception.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <list>
+#include <string>
+#include <utility>
+
+namespace cxx::test {
+
+struct Bench;
+
+struct Benches {
+    static Benches& get() {
+        static Benches ret;
+        return ret;
+    }
+
+    std::list<Bench*> benches;
+
+    void run(Bench& bench);
+    int run();
+};
+
+/**
+ * A benchmark.  `func_` is called with an iteration count `n`, and should perform the operation
+ * being measured `n` times.  `n` is grown until one call takes at least `kMinTime`; the time per
+ * iteration of that last call is what's reported.
+ */
+struct Bench {
+    using F = std::function<void(uint64_t)>;
+    constexpr static auto kMinTime = std::chrono::milliseconds(250);
+
+    std::string name_;
+    F func_;
+
+    Bench(std::string name, F func) : name_(std::move(name)), func_(std::move(func)) {
+        Benches::get().benches.push_back(this);
+    }
+};
+
+/** Keep the compiler from optimizing away `val` (and so the work which produced it). */
+template <typename T>
+void keep(T const& val) {
+    asm volatile("" : : "r,m"(val) : "memory");
+}
+
+void Benches::run(Bench& bench) {
+    using namespace std::chrono;
+    uint64_t n = 1;
+    while (true) {
+        auto start = steady_clock::now();
+        bench.func_(n);
+        auto elapsed = steady_clock::now() - start;
+        if (elapsed >= Bench::kMinTime) {
+            auto ns = duration<double, std::nano>(elapsed).count() / double(n);
+            printf("%-48s %12.2f ns/iter %14llu iters\n", bench.name_.data(), ns, (unsigned long long) n);
+            return;
+        }
+        // Aim a bit past `kMinTime` on the next call, but grow by 2x to 100x at a time.
+        auto const scale = duration<double>(Bench::kMinTime) / duration<double>(elapsed + 1ns);
+        n = uint64_t(double(n) * (scale < 2 ? 2 : scale > 100 ? 100 : scale * 1.2));
+    }
+}
+
+int Benches::run() {
+    auto it = benches.begin();
+    auto end = benches.end();
+    while (it != end) {
+        run(**it);
+        it = benches.erase(it);
+    }
+    return 0;
+}
+
+int runBenches() { return Benches::get().run(); }
+
+}  // namespace cxx::test
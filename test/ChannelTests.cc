@@ -0,0 +1,147 @@
+#include "cxx/Channel.h"
+#include "cxx/Generator.h"
+#include "cxx/Ref.h"
+#include "cxx/test/Test.h"
+
+#include <atomic>
+#include <cassert>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <thread>
+#include <vector>
+
+using cxx::test::Test;
+int main(int, char**) { return cxx::test::run(); }
+
+// Minimal fire-and-forget coroutine type, so tests can `co_await` channel ops
+struct Task {
+    struct promise_type {
+        Task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+Test trySendAndRecv([] {
+    cxx::Channel<int> ch(3);
+    assert(ch.capacity() == 4);
+    for (int i = 0; i < 4; i++) { assert(ch.trySend(i)); }
+    assert(!ch.trySend(99));  // full
+    for (int i = 0; i < 4; i++) { assert(ch.tryRecv() == i); }
+    assert(!ch.tryRecv());  // empty
+});
+
+Test closeDrainsThenEnds([] {
+    cxx::Channel<int> ch(4);
+    assert(ch.send(1));
+    assert(ch.send(2));
+    ch.close();
+    assert(ch.closed());
+    assert(!ch.trySend(3));
+    assert(!ch.send(3));
+    assert(!ch.drained());
+    assert(ch.recv() == 1);
+    assert(ch.recv() == 2);
+    assert(ch.drained());
+    assert(!ch.recv());
+});
+
+Test refsAcrossThreads([] {
+    constexpr int kProducers = 4;
+    constexpr int kConsumers = 4;
+    constexpr int kEach = 20000;
+    auto ch = cxx::Ref<cxx::Channel<cxx::Ref<int>>>::make(64);
+    std::atomic<int64_t> sum {0};
+    std::atomic<int> count {0};
+
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < kConsumers; c++) {
+        consumers.emplace_back([ch, &sum, &count] {
+            while (auto ref = ch->recv()) {
+                sum += **ref;
+                ++count;
+            }
+        });
+    }
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; p++) {
+        producers.emplace_back([ch] {
+            for (int i = 1; i <= kEach; i++) { assert(ch->send(cxx::Ref<int>::make(i))); }
+        });
+    }
+    for (auto& t : producers) { t.join(); }
+    ch->close();
+    for (auto& t : consumers) { t.join(); }
+    assert(count == kProducers * kEach);
+    assert(sum == int64_t(kProducers) * kEach * (kEach + 1) / 2);
+});
+
+Test generatorAdaptors([] {
+    cxx::Channel<int> ch(8);
+    auto gen = []() -> cxx::Generator<int> {
+        for (int i = 0; i < 1000; i++) { co_yield int(i); }
+    };
+    std::thread producer([&ch, &gen] {
+        assert(ch.sendAll(gen()) == 1000);
+        ch.close();
+    });
+    int expect = 0;
+    for (int x : ch.recvAll()) { assert(x == expect++); }
+    assert(expect == 1000);
+    producer.join();
+});
+
+Test asyncRecvResumedBySender([] {
+    cxx::Channel<int> ch(2);
+    std::atomic<int> sum {0};
+    std::atomic<bool> done {false};
+    auto consume = [](cxx::Channel<int>& ch, std::atomic<int>& sum, std::atomic<bool>& done) -> Task {
+        while (auto val = co_await ch.asyncRecv()) { sum += *val; }
+        done = true;
+        done.notify_one();
+    };
+    consume(ch, sum, done);  // suspends right away: nothing to receive yet
+    std::thread producer([&ch] {
+        for (int i = 1; i <= 1000; i++) { assert(ch.send(i)); }
+        ch.close();
+    });
+    producer.join();
+    done.wait(false);
+    assert(sum == 1000 * 1001 / 2);
+});
+
+Test asyncSendResumedByReceiver([] {
+    cxx::Channel<int> ch(2);
+    std::atomic<bool> done {false};
+    auto produce = [](cxx::Channel<int>& ch, std::atomic<bool>& done) -> Task {
+        for (int i = 1; i <= 1000; i++) { assert(co_await ch.asyncSend(i)); }
+        ch.close();
+        done = true;
+        done.notify_one();
+    };
+    produce(ch, done);  // fills the channel, then suspends
+    int expect = 1;
+    std::thread consumer([&ch, &expect] {
+        while (auto val = ch.recv()) { assert(*val == expect++); }
+    });
+    consumer.join();
+    done.wait(false);
+    assert(expect == 1001);
+});
+
+Test asyncSendFailsWhenClosed([] {
+    cxx::Channel<int> ch(2);
+    std::optional<bool> result;
+    auto produce = [](cxx::Channel<int>& ch, std::optional<bool>& result) -> Task {
+        while (co_await ch.asyncSend(1)) {}
+        result = false;
+    };
+    produce(ch, result);  // fills the channel, then suspends
+    assert(!result);
+    ch.close();  // resumes the producer (here, on this thread) with `false`
+    assert(result.has_value());
+});
@@ -2,7 +2,11 @@
 #include "cxx/test/Test.h"
 
 #include <cassert>
+#include <iomanip>
+#include <sstream>
 #include <string>
+#include <typeinfo>
+#include <vector>
 
 using cxx::test::Test;
 int main(int, char**) { return cxx::test::run(); }
@@ -20,3 +24,131 @@ Test testSimpleThrowCatch([] {
         assert(std::string("TestMessage") == e.what());
     }
 });
+
+Test streamedValues([] {
+    auto e = TestException() << "x=" << 42 << ' ' << 1.5 << ' ' << true << ' ' << std::string("s");
+    assert(std::string("x=42 1.5 1 s") == e.what());
+});
+
+Test streamManipulators([] {
+    auto e = TestException() << std::hex << 255 << ' ' << std::setw(4) << std::setfill('0') << 10
+                             << ' ' << std::dec << 10 << ' ' << std::boolalpha << true;
+    assert(std::string("ff 000a 10 true") == e.what());
+
+    char const* null = nullptr;
+    unsigned char const* bytes = (unsigned char const*) "abc";
+    auto f = TestException() << null << ' ' << bytes;
+    assert(std::string("(null) abc") == f.what());
+});
+
+Test formattedMessage([] {
+    try {
+        throw TestException().format("{}-{:03}", "id", 7) << '!';
+    } catch (TestException const& e) {
+        assert(std::string("id-007!") == e.what());
+        assert(e.what() == e.what());  // no copy per call
+    }
+});
+
+Test longMessageSpills([] {
+    std::string longStr(1000, 'x');
+    auto e = TestException() << "a" << longStr << "b";
+    auto copy = e;
+    assert(std::string("a" + longStr + "b") == copy.what());
+    assert(std::string(TestException().what()).empty());
+});
+
+struct PolicyException : cxx::Exception<PolicyException> {
+    using Exception::Exception;
+};
+
+Test capturePolicyPerType([] {
+    auto& capture = PolicyException::capture();
+    assert(PolicyException().traced_);
+
+    capture.set(cxx::CapturePolicy::never());
+    PolicyException e;
+    assert(!e.traced_ && !e.trace_.size());
+    std::stringstream ss;
+    e.dump(ss);
+    assert(ss.str().find("not captured") != std::string::npos);
+
+    capture.set(cxx::CapturePolicy::firstN(2));
+    assert(capture.policy() == cxx::CapturePolicy::firstN(2));  // mode and `n` set together
+    assert(PolicyException().traced_);
+    assert(PolicyException().traced_);
+    assert(!PolicyException().traced_);
+
+    capture.set(cxx::CapturePolicy::sampled(3));
+    unsigned traced = 0;
+    for (int i = 0; i < 9; i++) { traced += PolicyException().traced_; }
+    assert(traced == 3);
+
+    capture.set(cxx::CapturePolicy::always());
+});
+
+Test capturePolicyPerSite([] {
+    static cxx::CaptureControl site {cxx::CapturePolicy::never()};
+    PolicyException::capture().set(cxx::CapturePolicy::always());
+    try {
+        throw PolicyException(site) << "skipped";
+    } catch (PolicyException const& e) {
+        assert(!e.traced_);
+        assert(std::string("skipped") == e.what());
+    }
+    assert(PolicyException().traced_);
+});
+
+struct CountedException : cxx::Exception<CountedException> {};
+
+[[gnu::noinline]] void throwCounted() { throw CountedException(); }
+
+Test throwStatsPerSite([] {
+    for (int i = 0; i < 3; i++) {
+        try {
+            throwCounted();
+        } catch (CountedException const&) {}
+    }
+    CountedException other;  // a different site
+
+    std::vector<cxx::ThrowSite const*> sites;
+    cxx::ThrowStats::get().forEach([&](cxx::ThrowSite const& site) {
+        if (*site.type_ == typeid(CountedException)) { sites.push_back(&site); }
+    });
+    assert(sites.size() == 2);
+    uint64_t total = 0;
+    for (auto const* site : sites) {
+        auto count = site->count_.load();
+        assert(count == 1 || count == 3);
+        assert(site->firstNanos_.load() <= site->lastNanos_.load());
+        assert(site->sample_.size() > 0);
+        total += count;
+    }
+    assert(total == 4);
+});
+
+struct SampledException : cxx::Exception<SampledException> {};
+
+[[gnu::noinline]] void throwSampled() { throw SampledException(); }
+
+Test throwStatsOneSiteWhenSampled([] {
+    // Traced and untraced exceptions from one site must count as that one site
+    SampledException::capture().set(cxx::CapturePolicy::sampled(3));
+    unsigned traced = 0;
+    for (int i = 0; i < 7; i++) {
+        try {
+            throwSampled();
+        } catch (SampledException const& e) {
+            traced += e.traced_;
+        }
+    }
+    SampledException::capture().set(cxx::CapturePolicy::always());
+    assert(traced == 3);
+
+    std::vector<cxx::ThrowSite const*> sites;
+    cxx::ThrowStats::get().forEach([&](cxx::ThrowSite const& site) {
+        if (*site.type_ == typeid(SampledException)) { sites.push_back(&site); }
+    });
+    assert(sites.size() == 1);
+    assert(sites[0]->count_.load() == 7);
+});
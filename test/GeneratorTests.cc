@@ -7,6 +7,10 @@
 #include <cassert>
 #include <functional>
 #include <ranges>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
 
 using cxx::test::Test;
 int main(int, char**) { return cxx::test::run(); }
@@ -88,3 +92,128 @@ Test noLeaksViaYield([] {
     for (auto b : genBars()) { (void) b; }
     // LSAN build will trigger an error if any leaks
 });
+
+cxx::Generator<int> count(int n) {
+    for (int i = 0; i < n; i++) { co_yield int(i); }
+}
+
+Test genPropagatesException([] {
+    auto gen = []() -> cxx::Generator<int> {
+        co_yield 1;
+        throw std::runtime_error("oops");
+    }();
+    int seen = 0;
+    try {
+        for (int x : gen) { seen += x; }
+        assert(false);
+    } catch (std::runtime_error const&) { assert(seen == 1); }
+});
+
+Test parallelMapKeepsOrder([] {
+    auto gen = count(1000) | cxx::parallelMap([](int x) { return x * 3; }, 4, 8);
+    int expect = 0;
+    for (int x : gen) {
+        assert(x == expect * 3);
+        ++expect;
+    }
+    assert(expect == 1000);
+});
+
+Test parallelMapPropagatesException([] {
+    auto f = [](int x) {
+        if (x == 5) { throw std::runtime_error("five"); }
+        return x;
+    };
+    int seen = 0;
+    try {
+        for (int x : count(100) | cxx::parallelMap(f, 3, 6)) { assert(x == seen++); }
+        assert(false);
+    } catch (std::runtime_error const&) { assert(seen == 5); }
+});
+
+Test parallelMapStopEarly([] {
+    auto gen = count(1000) | cxx::parallelMap([](int x) { return cxx::Ref<int>::make(x); });
+    for (auto ref : gen) {
+        if (*ref == 10) { break; }  // abandon the rest; workers should shut down cleanly
+    }
+});
+
+Test prefetchKeepsOrder([] {
+    auto const consumer = std::this_thread::get_id();
+    auto gen = [consumer]() -> cxx::Generator<int> {
+        assert(std::this_thread::get_id() != consumer);  // runs on the producer thread
+        for (int i = 0; i < 1000; i++) { co_yield int(i); }
+    };
+    int expect = 0;
+    for (int x : cxx::prefetch(gen(), 4)) { assert(x == expect++); }
+    assert(expect == 1000);
+});
+
+Test prefetchPropagatesException([] {
+    auto gen = []() -> cxx::Generator<int> {
+        co_yield 1;
+        co_yield 2;
+        throw std::runtime_error("oops");
+    };
+    int seen = 0;
+    try {
+        for (int x : cxx::prefetch(gen())) { seen += x; }
+        assert(false);
+    } catch (std::runtime_error const&) { assert(seen == 3); }
+});
+
+Test prefetchStopEarly([] {
+    for (int x : cxx::prefetch(count(1000000), 2)) {
+        if (x == 10) { break; }  // producer is blocked on a full ring; must still shut down
+    }
+});
+
+cxx::Generator<int> ints(std::vector<int> vals) {
+    for (int x : vals) { co_yield int(x); }
+}
+
+Test mergeSortedStreams([] {
+    auto merged = cxx::mergeSorted(ints({1, 4, 7}), ints({}), ints({2, 5, 8, 9}), ints({3, 6}));
+    assert(merged.to<std::vector<int>>() == std::vector<int>({1, 2, 3, 4, 5, 6, 7, 8, 9}));
+
+    auto desc = cxx::mergeSorted(ints({9, 5, 1}), ints({8, 2}), std::greater<> {});
+    assert(desc.to<std::vector<int>>() == std::vector<int>({9, 8, 5, 2, 1}));
+});
+
+Test mergeSortedIsStable([] {
+    using P = std::pair<int, int>;  // (key, source)
+    auto gen = [](int src, std::vector<int> keys) -> cxx::Generator<P> {
+        for (int k : keys) { co_yield P(k, src); }
+    };
+    auto byKey = [](P const& a, P const& b) { return a.first < b.first; };
+    std::vector<cxx::Generator<P>> sources;
+    sources.push_back(gen(0, {1, 2, 2}));
+    sources.push_back(gen(1, {2, 3}));
+    sources.push_back(gen(2, {1, 2}));
+    auto got = cxx::mergeSorted(std::move(sources), byKey).to<std::vector<P>>();
+    assert(got == std::vector<P>({{1, 0}, {1, 2}, {2, 0}, {2, 0}, {2, 1}, {2, 2}, {3, 1}}));
+});
+
+Test groupByRuns([] {
+    std::vector<std::pair<int, std::vector<int>>> got;
+    for (auto group : ints({1, 3, 5, 2, 4, 7, 9, 11}) | cxx::groupBy([](int x) { return x % 2; })) {
+        got.emplace_back(group.key, group.values.to<std::vector<int>>());
+    }
+    assert(got.size() == 3);
+    assert(got[0] == std::make_pair(1, std::vector<int>({1, 3, 5})));
+    assert(got[1] == std::make_pair(0, std::vector<int>({2, 4})));
+    assert(got[2] == std::make_pair(1, std::vector<int>({7, 9, 11})));
+});
+
+Test groupBySkipsUnconsumed([] {
+    std::vector<int> keys;
+    for (auto group : count(100) | cxx::groupBy([](int x) { return x / 10; })) {
+        keys.push_back(group.key);
+        if (group.key % 2) {
+            for (int x : group.values) {
+                if (x % 10 == 3) { break; }  // take only part of this run
+            }
+        }
+    }
+    assert(keys == std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+});
@@ -125,3 +125,68 @@ Test parsingIntoJSONObjects([] {
 //     expectParsedValue(cxx::JSON(Map {}), "{}");
 //     expectParsedValue(cxx::JSON(Map {{"x", {"y", "z"}}}), R"({"x":["y","z"]})");
 // });
+
+Test arrayIndexing([] {
+    auto json = *cxx::JSON::parse(cxx::String(R"([10,"x",[true,null]])"));
+    assert(json[0] == cxx::JSON(10));
+    assert(json[1] == cxx::JSON("x"));
+    assert(json[2][0] == cxx::JSON(true));
+    assert(json[2][1] == cxx::JSON(nullptr));
+});
+
+Test largeArrayRoundTrip([] {
+    std::vector<int> vals;
+    std::string str = "[";
+    for (int i = 0; i < 1000; i++) {
+        vals.push_back(i);
+        str += (i ? "," : "") + std::to_string(i);
+    }
+    str += "]";
+    auto json = *cxx::JSON::parse(str);
+    assert(json == cxx::JSON(vals));
+    assert(json[999] == cxx::JSON(999));
+    assert(json.str() == cxx::String(str));
+});
+
+Test tryParseReportsErrors([] {
+    using Code = cxx::ParseError::Code;
+    auto expectError = [](cxx::String str, Code code, unsigned line, unsigned col) {
+        auto result = cxx::JSON::tryParse(str);
+        assert(!result);
+        assert(result.error().code == code);
+        assert(result.error().line == line);
+        assert(result.error().col == col);
+    };
+    expectError("", Code::UNEXPECTED_EOF, 1, 1);
+    expectError("nul", Code::UNEXPECTED_EOF, 1, 4);
+    expectError("[1,", Code::UNEXPECTED_EOF, 1, 4);
+    expectError("\"abc", Code::UNEXPECTED_EOF, 1, 5);
+    expectError("[1 2]", Code::UNEXPECTED_CHAR, 1, 4);
+    expectError(",", Code::UNEXPECTED_DELIMITER, 1, 1);
+    expectError("{\"a\":,}", Code::EXPECTED_KEY_VAL, 1, 7);
+    expectError("{\n  \"a\": 1,\n  b}", Code::UNEXPECTED_CHAR, 3, 3);
+
+    auto ok = cxx::JSON::tryParse(cxx::String(R"({"a":[1,2]})"));
+    assert(ok);
+    assert((*ok).str() == cxx::String(R"({"a":[1,2]})"));
+});
+
+Test parseErrorToException([] {
+    auto result = cxx::JSON::parse(cxx::String("[1 2]"));
+    assert(!result);
+    try {
+        (void) *result;
+        assert(false);
+    } catch (cxx::ParseException const& exc) {
+        assert(std::strstr(exc.what(), "line 1, column 4") != nullptr);
+    }
+});
+
+Test throwStatsAsJSON([] {
+    (void) cxx::ParseError {}.exception();
+    auto str = std::string(cxx::ThrowStats::get().json().str());
+    assert(str.starts_with("[{\"type\":"));
+    assert(str.find("\"cxx::ParseException\"") != std::string::npos);
+    assert(str.find("\"count\":") != std::string::npos);
+    assert(str.find("\"sample\":[\"0x") != std::string::npos);
+});
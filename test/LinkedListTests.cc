@@ -0,0 +1,180 @@
+#include "cxx/LinkedList.h"
+#include "cxx/Ref.h"
+#include "cxx/test/Test.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using cxx::test::Test;
+int main(int, char**) { return cxx::test::run(); }
+
+Test linkedListPushAndIterate([] {
+    cxx::LinkedList<int> list;
+    list.pushBack(cxx::Ref<int>::make(2));
+    list.pushBack(cxx::Ref<int>::make(3));
+    list.pushFront(cxx::Ref<int>::make(1));
+    std::vector<int> got;
+    for (int x : list) { got.push_back(x); }
+    assert(got == std::vector<int>({1, 2, 3}));
+});
+
+static_assert(std::ranges::forward_range<cxx::UnrolledList<int, 4>>);
+
+Test unrolledListPushBothEnds([] {
+    cxx::UnrolledList<int, 4> list;
+    assert(list.empty());
+    for (int i = 0; i < 10; i++) { list.pushBack(i); }
+    for (int i = -1; i >= -10; i--) { list.pushFront(i); }
+    assert(list.size() == 20);
+    assert(list.front() == -10);
+    assert(list.back() == 9);
+    int expect = -10;
+    for (int x : list) {
+        assert(x == expect++);
+    }
+    assert(expect == 10);
+});
+
+Test unrolledListStableRefs([] {
+    cxx::UnrolledList<std::string, 2> list;
+    auto& first = list.emplaceBack("first");
+    auto it = list.begin();
+    for (int i = 0; i < 100; i++) {
+        list.pushBack(std::to_string(i));
+        list.pushFront(std::to_string(-i));
+    }
+    assert(&first == &*it);  // neither the item nor the iterator to it were disturbed
+    assert(*it == "first");
+    assert(*++it == "0");
+
+    auto copy = list;
+    assert(copy == list);
+    auto moved = std::move(copy);
+    assert(moved == list);
+    assert(copy.empty());  // NOLINT(bugprone-use-after-move)
+});
+
+Test unrolledListThrowingCtor([] {
+    struct Throws {
+        explicit Throws(bool doThrow) {
+            if (doThrow) { throw std::runtime_error("nope"); }
+        }
+    };
+    cxx::UnrolledList<Throws, 1> list;
+    list.emplaceBack(false);
+    try {
+        list.emplaceBack(true);  // needs a new node
+        assert(false);
+    } catch (std::runtime_error const&) {}
+    assert(list.size() == 1);
+    int count = 0;
+    for (auto const& x : list) { (void) x, ++count; }
+    assert(count == 1);
+});
+
+Test unrolledListThrowingCopy([] {
+    static int live = 0;
+    static int copiesLeft = 0;
+    struct Counted {
+        Counted() { ++live; }
+        Counted(Counted const&) {
+            if (!copiesLeft--) { throw std::runtime_error("nope"); }
+            ++live;
+        }
+        ~Counted() { --live; }
+    };
+    {
+        cxx::UnrolledList<Counted, 2> list;
+        for (int i = 0; i < 5; i++) { list.emplaceBack(); }
+        copiesLeft = 3;  // fails partway, after filling a node and a half
+        try {
+            cxx::UnrolledList<Counted, 2> copy(list);
+            assert(false);
+        } catch (std::runtime_error const&) {}
+        assert(live == 5);  // the partial copy's items were all destroyed
+    }
+    assert(live == 0);
+});
+
+Test mpscQueueFIFO([] {
+    cxx::MPSCQueue<int> queue;
+    assert(queue.empty());
+    assert(!queue.pop());
+    for (int i = 0; i < 5; i++) { queue.push(cxx::Ref<int>::make(i)); }
+    for (int i = 0; i < 5; i++) { assert(*queue.pop() == i); }
+    assert(!queue.pop());
+});
+
+Test mpscQueueManyProducers([] {
+    constexpr int kProducers = 4;
+    constexpr int kEach = 20000;
+    cxx::MPSCQueue<int> queue;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; p++) {
+        producers.emplace_back([&queue, p] {
+            for (int i = 0; i < kEach; i++) { queue.push(cxx::Ref<int>::make(p * kEach + i)); }
+        });
+    }
+    // Per producer, items must come out in the order that producer pushed them
+    std::vector<int> last(kProducers, -1);
+    int count = 0;
+    while (count < kProducers * kEach) {
+        auto ref = queue.pop();
+        if (!ref) {
+            std::this_thread::yield();
+            continue;
+        }
+        int p = *ref / kEach;
+        assert(*ref > last[p]);
+        last[p] = *ref;
+        ++count;
+    }
+    for (auto& t : producers) { t.join(); }
+    assert(!queue.pop());
+});
+
+Test treiberStackLIFO([] {
+    cxx::TreiberStack<int> stack;
+    assert(stack.empty());
+    assert(!stack.pop());
+    for (int i = 0; i < 5; i++) { stack.push(cxx::Ref<int>::make(i)); }
+    for (int i = 4; i >= 0; i--) { assert(*stack.pop() == i); }
+    assert(!stack.pop());
+});
+
+Test treiberStackConcurrent([] {
+    // Each thread repeatedly pushes and pops; the same items keep circulating through the
+    // stack, so popped nodes are retired and reclaimed (and new nodes allocated) constantly.
+    constexpr int kThreads = 4;
+    constexpr int kItems = 64;
+    constexpr int kRounds = 20000;
+    cxx::TreiberStack<int> stack;
+    for (int i = 0; i < kItems; i++) { stack.push(cxx::Ref<int>::make(i)); }
+    std::atomic<int64_t> popped {0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&] {
+            for (int r = 0; r < kRounds; r++) {
+                if (auto ref = stack.pop()) {
+                    ++popped;
+                    stack.push(std::move(ref));
+                }
+            }
+        });
+    }
+    for (auto& t : threads) { t.join(); }
+    assert(popped > 0);
+    // Everything we started with must still be there, exactly once
+    std::vector<bool> seen(kItems);
+    while (auto ref = stack.pop()) {
+        assert(!seen[*ref]);
+        seen[*ref] = true;
+    }
+    for (bool s : seen) { assert(s); }
+});
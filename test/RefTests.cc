@@ -114,6 +114,28 @@ Test refInsideStruct([] {
     assert(dtorCount == 0);
 });
 
+struct Link {
+    cxx::Ref<Link> next;
+    Foo foo;
+};
+
+Test assignFromReleased([] {
+    // Each assignment releases the only ref to the `Link` holding the one assigned from
+    auto head = cxx::Ref<Link>::make();
+    head->next = cxx::Ref<Link>::make();
+    head->next->next = cxx::Ref<Link>::make();
+    head = head->next;
+    assert(head._refs() == 1);
+    assert(dtorCount == 1);
+    head = std::move(head->next);
+    assert(head._refs() == 1);
+    assert(dtorCount == 2);
+    head = head;
+    assert(head._refs() == 1);
+    head = std::move(head);
+    assert(head._refs() == 1 && head->foo.a == 42);
+});
+
 Test refInsideRef([] {
     auto bar = cxx::Ref<Bar>::make(cxx::Ref<Foo>::make());
     assert(bar->foo._refs() == 1);
@@ -0,0 +1,83 @@
+#include "cxx/Ref.h"
+#include "cxx/SmallVector.h"
+#include "cxx/test/Test.h"
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <ranges>
+#include <string>
+#include <utility>
+
+using cxx::test::Test;
+int main(int, char**) { return cxx::test::run(); }
+
+static_assert(std::ranges::contiguous_range<cxx::SmallVector<int, 4>>);
+static_assert(std::ranges::sized_range<cxx::SmallVector<int, 4>>);
+
+Test inlineThenHeap([] {
+    cxx::SmallVector<int, 4> vec;
+    auto const* inlineData = vec.data();
+    for (int i = 0; i < 4; i++) { vec.pushBack(i); }
+    assert(vec.data() == inlineData);  // still inline
+    assert(vec.capacity() == 4);
+    vec.pushBack(4);
+    assert(vec.data() != inlineData);  // moved to the heap
+    assert(vec.capacity() >= 5);
+    assert(vec.size() == 5);
+    for (int i = 0; i < 5; i++) { assert(vec[i] == i); }
+    assert(vec.front() == 0);
+    assert(vec.back() == 4);
+    vec.popBack();
+    assert(vec.size() == 4);
+});
+
+Test moveOnlyItems([] {
+    cxx::SmallVector<std::unique_ptr<std::string>, 2> vec;
+    for (int i = 0; i < 10; i++) { vec.emplaceBack(std::make_unique<std::string>(std::to_string(i))); }
+    auto moved = std::move(vec);
+    assert(vec.empty());  // NOLINT(bugprone-use-after-move)
+    assert(moved.size() == 10);
+    int i = 0;
+    for (auto const& p : moved) { assert(*p == std::to_string(i++)); }
+});
+
+Test copyMoveAndCompare([] {
+    cxx::SmallVector<std::string, 2> small {"a", "b"};
+    cxx::SmallVector<std::string, 2> big {"a", "b", "c", "d"};
+    auto small2 = small;
+    auto big2 = big;
+    assert(small2 == small);
+    assert(big2 == big);
+    assert(!(small == big));
+
+    auto small3 = std::move(small2);  // moves items out of inline storage
+    auto big3 = std::move(big2);      // steals the heap buffer
+    assert(small3 == small);
+    assert(big3 == big);
+
+    small3 = big;
+    assert(small3 == big);
+    big3 = std::move(small);
+    assert(big3.size() == 2);
+});
+
+Test pushBackOwnItemWhileGrowing([] {
+    cxx::SmallVector<std::string, 1> vec {"hello"};
+    for (int i = 0; i < 6; i++) { vec.pushBack(vec[0]); }  // some of these grow, while copying `vec[0]`
+    assert(vec.size() == 7);
+    for (auto const& s : vec) { assert(s == "hello"); }
+});
+
+Test destroysItems([] {
+    auto ref = cxx::Ref<int>::make(42);
+    {
+        cxx::SmallVector<cxx::Ref<int>, 2> vec;
+        for (int i = 0; i < 5; i++) { vec.pushBack(ref); }
+        assert(ref._refs() == 6);
+        vec.clear();
+        assert(ref._refs() == 1);
+        vec.pushBack(ref);
+    }
+    assert(ref._refs() == 1);
+});
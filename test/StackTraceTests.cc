@@ -2,9 +2,25 @@
 #include "cxx/String.h"
 #include "cxx/test/Test.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <dlfcn.h>
+#include <filesystem>
+#include <fstream>
 #include <list>
+#include <new>
+#include <set>
+#include <signal.h>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
 
 using cxx::test::Test;
 int main(int, char**) { return cxx::test::run(); }
@@ -18,3 +34,852 @@ Test simpleDump([] {
     auto lines = cxx::String(ss.str()).split('\n').to<std::list<cxx::String>>();
     assert(lines.size() > 1);
 });
+
+Test framesBuiltLazily([] {
+    cxx::StackTrace s;
+    assert(s.size() > 1);
+    assert(!s.frame);  // nothing allocated yet
+    size_t count = 0;
+    for (auto* sf : s) {
+        assert(sf->address == s.address(count));
+        ++count;
+    }
+    assert(count == s.size());
+    assert(s.frame);
+});
+
+Test framesSharedAcrossThreads([] {
+    cxx::StackTrace s;
+    auto copy = s;  // frames not built yet, so each builds its own
+    std::vector<std::thread> threads;
+    std::vector<cxx::StackFrame*> heads(4);
+    for (size_t i = 0; i < heads.size(); i++) {
+        threads.emplace_back([&, i] {
+            heads[i] = s.frames().get();
+            std::stringstream ss;
+            s.dump(ss);
+        });
+    }
+    for (auto& thread : threads) { thread.join(); }
+    for (auto* head : heads) { assert(head && head == heads[0]); }
+    assert(copy.frames().get() != heads[0]);
+
+    // A copy's frames are its own, even if the original's were built (and being resolved)
+    auto again = s;
+    assert(again.frames().get() != heads[0]);
+    assert(again.size() == s.size() && again.frames()->address == heads[0]->address);
+    copy = s;
+    assert(copy.frames().get() != heads[0]);
+    threads.clear();
+    for (auto const* trace : {&s, &again, &copy}) {
+        threads.emplace_back([trace] {
+            cxx::StackResolver sr;
+            trace->resolve(sr);
+            std::stringstream ss;
+            trace->dump(ss);
+        });
+    }
+    for (auto& thread : threads) { thread.join(); }
+    assert(again.frames()->sym() == s.frames()->sym());
+});
+
+[[gnu::noinline]] void recurse(unsigned n, size_t maxDepth, size_t& depth) {
+    if (n) {
+        recurse(n - 1, maxDepth, depth);
+        asm volatile("");  // not a tail call, so each level keeps its frame
+        return;
+    }
+    cxx::StackTrace s(maxDepth);
+    depth = s.size();
+}
+
+Test maxDepth([] {
+    size_t depth = 0;
+    recurse(10, 3, depth);
+    assert(depth == 3);
+    recurse(2 * cxx::StackTrace::kMaxDepth, 1000, depth);
+    assert(depth == cxx::StackTrace::kMaxDepth);
+});
+
+Test openOwnBinary([] {
+    Dl_info info;
+    dladdr((void*) &recurse, &info);
+    auto bin = cxx::Binary::open(info.dli_fname, 0);
+    assert(bin);
+    std::set<std::string> names;
+    for (auto const& section : bin->sections()) { names.insert(section->name()); }
+    // Either ELF or Mach-O naming
+    assert(names.contains(".text") || names.contains("__text"));
+    assert(names.contains(".debug_line") || names.contains("__debug_line"));
+});
+
+Test binariesCachedAcrossResolvers([] {
+    cxx::StackTrace s;
+    cxx::StackResolver sr1;
+    s.resolve(sr1);
+    s.resolve(sr1);  // again, with the same resolver: no duplicates
+    for (size_t i = 0; i < sr1.binaries.size(); i++) {
+        for (size_t j = i + 1; j < sr1.binaries.size(); j++) {
+            assert(sr1.binaries[i].get() != sr1.binaries[j].get());
+        }
+    }
+
+    cxx::StackResolver sr2;
+    s.resolve(sr2);
+    assert(sr1.binaries.size() == sr2.binaries.size());
+    for (size_t i = 0; i < sr1.binaries.size(); i++) {
+        assert(sr1.binaries[i].get() == sr2.binaries[i].get());  // opened only once
+        assert(&sr1.binaries[i]->lines() == &sr2.binaries[i]->lines());
+    }
+});
+
+Test binaryCacheGrowsByPath([] {
+    auto& cache = cxx::BinaryCache::get();
+    auto const* mod = cxx::ModuleMap::get().find(uintptr_t(&recurse));
+    assert(mod);
+    cxx::StackTrace s;
+    cxx::StackResolver sr;
+    s.resolve(sr);
+    auto bin = cache.open(mod->path, 0);
+    assert(bin);
+
+    // One entry per path, opened or not, however many threads ask for it
+    auto const before = cache.size();
+    auto const dir = "/tmp/binaryCacheGrowsByPath." + std::to_string(getpid()) + "/";
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 500; i++) {
+                assert(!cache.open(dir + std::to_string(i), 0));
+                assert(cache.open(mod->path, 0).get() == bin.get());
+            }
+        });
+    }
+    for (auto& thread : threads) { thread.join(); }
+    assert(cache.size() == before + 500);
+
+#if !defined(__APPLE__)
+    // There are no `.dSYM`s to probe for here, so resolving didn't add (failed) entries for them
+    auto progName = std::filesystem::path(mod->path).filename().string();
+    cache.open(mod->path + ".dSYM/Contents/Resources/DWARF/" + progName, 0);
+    assert(cache.size() == before + 501);
+#endif
+});
+
+Test lineTableLookup([] {
+    cxx::LineTable lt;
+    auto a = lt.intern("a.cc");
+    auto b = lt.intern("b.cc");
+    assert(lt.intern("a.cc") == a);
+    lt.add(0x100, a, 10, 1);
+    lt.add(0x108, a, 10, 1);  // same location: merged into the previous row
+    lt.add(0x110, a, 11, 2);
+    lt.add(0x110, b, 20, 3);  // same address: this later row wins
+    lt.addEnd(0x120);         // gap from here
+    lt.add(0x200, b, 30, 0);
+    lt.addEnd(0x210);
+    lt.finish();
+    assert(lt.size() == 5);
+
+    assert(!lt.find(0xff));
+    assert(lt.find(0x100)->line == 10);
+    assert(lt.find(0x10f)->line == 10);
+    auto const* row = lt.find(0x118);
+    assert(row->line == 20 && row->col == 3 && lt.file(*row) == "b.cc");
+    assert(!lt.find(0x120));
+    assert(!lt.find(0x1ff));
+    assert(lt.find(0x200)->line == 30);
+    assert(!lt.find(0x1000));
+});
+
+Test lineTableEndMarkerLoses([] {
+    // Sequences out of address order: the second's first row, then the first's end, at 0x200
+    cxx::LineTable lt;
+    auto a = lt.intern("a.cc");
+    lt.add(0x200, a, 20, 1);
+    lt.add(0x208, a, 21, 1);
+    lt.addEnd(0x210);
+    lt.add(0x100, a, 10, 1);
+    lt.addEnd(0x200);
+    lt.finish();
+    assert(lt.find(0x100)->line == 10);
+    assert(lt.find(0x200) && lt.find(0x200)->line == 20);
+    assert(lt.find(0x208)->line == 21);
+    assert(!lt.find(0x210));
+});
+
+Test linesDecodedLazily([] {
+    Dl_info info;
+    dladdr((void*) &recurse, &info);
+    auto bin = cxx::Binary::open(info.dli_fname, 0);
+    assert(bin);
+    bin->rebase(uintptr_t(info.dli_fbase));
+    cxx::LineIndex index(bin.get());
+    if (!index.unitCount()) { return; }  // no line info in here (e.g. it's in a .dSYM)
+    assert(index.decodedCount() == 0);
+
+    auto hit = index.find(uintptr_t(&recurse) - bin->vmaSlide_);
+    assert(hit);
+    assert(hit.row->line > 0);
+    assert(hit.table->file(*hit.row).ends_with("StackTraceTests.cc"));
+    assert(index.decodedCount() >= 1);
+});
+
+Test linesMissOutsideUnits([] {
+    Dl_info info;
+    dladdr((void*) &recurse, &info);
+    auto bin = cxx::Binary::open(info.dli_fname, 0);
+    assert(bin);
+    cxx::LineIndex index(bin.get());
+    if (!index.unitCount()) { return; }  // no line info in here (e.g. it's in a .dSYM)
+
+    // In no unit's ranges (startup code has no line info); so nothing need be decoded
+    assert(!index.find(1));
+    for (auto const& sym : bin->symbols().symbols()) {
+        if (std::string_view(sym.name) == "_start") { assert(!index.find(sym.addr)); }
+    }
+    assert(index.decodedCount() == 0);
+});
+
+Test linesDecodedInParallel([] {
+    Dl_info info;
+    dladdr((void*) &recurse, &info);
+    auto bin = cxx::Binary::open(info.dli_fname, 0);
+    assert(bin);
+    bin->rebase(uintptr_t(info.dli_fbase));
+    cxx::LineIndex serial(bin.get());
+    cxx::LineIndex parallel(bin.get());
+    serial.decodeAll(1);
+    parallel.decodeAll(4);
+    assert(parallel.decodedCount() == serial.decodedCount());
+
+    auto addr = uintptr_t(&recurse) - bin->vmaSlide_;
+    auto a = serial.find(addr);
+    auto b = parallel.find(addr);
+    assert(bool(a) == bool(b));
+    if (a) { assert(a.row->addr == b.row->addr && a.row->line == b.row->line); }
+});
+
+// Even at -O0, these are inlined (and so appear in debug info as inlined calls)
+[[gnu::always_inline]] inline void captureInlined(cxx::StackTrace* out) {
+    new (out) cxx::StackTrace();
+}
+[[gnu::always_inline]] inline void captureInlined2(cxx::StackTrace* out) {
+    captureInlined(out);
+}
+[[gnu::noinline]] void captureCaller(cxx::StackTrace* out) {
+    captureInlined2(out);
+    asm volatile("");  // so the capture isn't a tail call, leaving this frame out
+}
+
+Test inlinedFrames([] {
+    Dl_info info;
+    dladdr((void*) &captureCaller, &info);
+    auto bin = cxx::Binary::open(info.dli_fname, 0);
+    assert(bin);
+    if (!bin->functions().unitCount()) { return; }  // no debug info in here (e.g. in a .dSYM)
+
+    alignas(cxx::StackTrace) char buf[sizeof(cxx::StackTrace)];
+    auto* trace = (cxx::StackTrace*) buf;
+    captureCaller(trace);
+    cxx::StackResolver sr;
+    trace->resolve(sr);
+
+    std::vector<cxx::StackFrame const*> frames;
+    for (auto* sf : *trace) { frames.push_back(sf); }
+    auto it = std::ranges::find_if(frames, [](auto* sf) {
+        return sf->sym() == "captureCaller(cxx::StackTrace*)";
+    });
+    assert(it != frames.end() && it - frames.begin() >= 2);
+    // Frames for both inlined functions, at the same address, before the real one
+    assert(it[-2]->sym().starts_with("captureInlined(") && it[-2]->inlined);
+    assert(it[-1]->sym().starts_with("captureInlined2(") && it[-1]->inlined);
+    assert(it[-1]->address == it[0]->address && !it[0]->inlined);
+    // Each at the line where the next inlined it
+    assert(it[-1]->loc.line && it[0]->loc.line == it[-1]->loc.line + 3);
+    assert(it[0]->loc.sourceFile.ends_with("StackTraceTests.cc"));
+    trace->~StackTrace();
+});
+
+Test symbolTableLookup([] {
+    cxx::SymbolTable st;
+    st.add(0x200, 0x10, "b");
+    st.add(0x100, 0, "a");     // no size: extends to the next symbol
+    st.add(0x200, 0, "alias");  // same address as "b", which has a size, so is kept
+    st.add(0x300, 0, "");       // nameless: ignored
+    st.add(0x400, 0, "c");      // last, and no size: only its own address
+    st.finish();
+    assert(st.size() == 3);
+    assert(!st.find(0xff));
+    assert(std::string(st.find(0x100)->name) == "a");
+    assert(std::string(st.find(0x1ff)->name) == "a");
+    assert(std::string(st.find(0x20f)->name) == "b");
+    assert(!st.find(0x210));
+    assert(std::string(st.find(0x400)->name) == "c");
+    assert(!st.find(0x401));
+});
+
+// Not exported, so `dladdr` can't name it
+[[gnu::noinline]] static void staticCapture(cxx::StackTrace* out) {
+    new (out) cxx::StackTrace();
+    asm volatile("");  // not a tail call, so this frame is in the trace
+}
+
+Test staticFunctionNamed([] {
+    Dl_info info;
+    dladdr((void*) &staticCapture, &info);
+    auto bin = cxx::Binary::open(info.dli_fname, 0);
+    assert(bin);
+    bin->rebase(uintptr_t(info.dli_fbase));
+    auto const& syms = bin->symbols();
+    if (syms.empty()) { return; }  // stripped
+    auto const* sym = syms.find(uintptr_t(&staticCapture) - bin->vmaSlide_ + 1);
+    assert(sym && cxx::demangle(sym->name) == "staticCapture(cxx::StackTrace*)");
+
+    alignas(cxx::StackTrace) char buf[sizeof(cxx::StackTrace)];
+    auto* trace = (cxx::StackTrace*) buf;
+    staticCapture(trace);
+    cxx::StackResolver sr;
+    trace->resolve(sr);
+    assert(trace->begin() != trace->end());
+    assert((*trace->begin())->sym() == "staticCapture(cxx::StackTrace*)");
+    trace->~StackTrace();
+});
+
+Test lookupsAtLoadBase([] {
+    auto const* mod = cxx::ModuleMap::get().find(uintptr_t(&staticCapture));
+    if (!mod) { return; }  // no `dl_iterate_phdr` here
+    cxx::StackResolver sr;
+    sr.findBinaries(mod->path);
+    auto addr = uintptr_t(&staticCapture) + 1;
+    auto const* sym = sr.findSymbol(addr, mod->path, mod->begin);
+    if (!sym) { return; }  // stripped
+    assert(cxx::demangle(sym) == "staticCapture(cxx::StackTrace*)");
+
+    // The same binary loaded elsewhere (e.g. after a `dlclose` and `dlopen`, or in another
+    // process): found by that load's own base, not the one it was first resolved at
+    constexpr static uintptr_t kShift = 0x10000000;
+    assert(sr.findSymbol(addr + kShift, mod->path, mod->begin + kShift) == sym);
+    assert(!sr.findSymbol(addr + kShift, mod->path, mod->begin));
+    auto loc = sr.findLocation(addr, mod->path, mod->begin);
+    auto shifted = sr.findLocation(addr + kShift, mod->path, mod->begin + kShift);
+    assert(shifted.line == loc.line && shifted.virtualAddr == loc.virtualAddr);
+    auto scopes = sr.findFunctions(addr + kShift, mod->path, mod->begin + kShift);
+    assert(scopes.size() == sr.findFunctions(addr, mod->path, mod->begin).size());
+});
+
+Test moduleMap([] {
+    auto& map = cxx::ModuleMap::get();
+    Dl_info info;
+    dladdr((void*) &recurse, &info);
+    auto const* mod = map.find(uintptr_t(&recurse));
+    if (map.modules().empty()) { return; }  // no `dl_iterate_phdr` here
+    assert(mod);
+    assert(std::filesystem::equivalent(mod->path, info.dli_fname));
+    assert(mod->begin == uintptr_t(info.dli_fbase));
+
+    // Same bias as found by opening the file
+    auto bin = cxx::Binary::open(mod->path, 0);
+    bin->rebase(mod->begin);
+    assert(bin->vmaSlide_ == mod->bias);
+
+    // Another object: the C library
+    dladdr((void*) &dladdr, &info);
+    auto const* libc = map.find(uintptr_t(&dladdr));
+    assert(libc && libc != mod);
+    assert(std::filesystem::equivalent(libc->path, info.dli_fname));
+    assert(!map.find(0x10));
+});
+
+Test debugLinkCRC([] {
+    auto const* check = (uint8_t const*) "123456789";
+    assert(cxx::detail::crc32(check, 9) == 0xcbf43926);  // the standard check value
+    assert(cxx::detail::crc32(check + 4, 5, cxx::detail::crc32(check, 4)) == 0xcbf43926);
+});
+
+Test debugFileByBuildID([] {
+    Dl_info info;
+    dladdr((void*) &recurse, &info);
+    auto bin = cxx::Binary::open(info.dli_fname, 0);
+    auto id = bin->buildID();
+    if (id.empty()) { return; }  // not linked with `--build-id`
+    assert(id.size() >= 16);
+
+    // Put a copy where a debug info package would, under a debug dir of our own
+    namespace fs = std::filesystem;
+    auto dir = fs::temp_directory_path() / ("cxx-debug-" + std::to_string(getpid()));
+    auto debug = dir / ".build-id" / id.substr(0, 2) / (id.substr(2) + ".debug");
+    fs::create_directories(debug.parent_path());
+    fs::copy_file(info.dli_fname, debug);
+
+    auto& files = cxx::DebugFiles::get();
+    auto saved = files.dirs();
+    files.setDirs({dir.string()});
+    auto found = files.find(*bin);
+    assert(found.size() == 1);
+    assert(found[0]->file_->path_ == debug.string());
+    assert(found[0]->buildID() == id);
+    assert(files.find(*bin)[0].get() == found[0].get());  // remembered by build ID
+    files.setDirs(saved);
+    fs::remove_all(dir);
+});
+
+// Building test inputs (in host byte order, taken to be little-endian, as ELF64 files read here)
+
+template <typename T>
+void put(std::string& out, T val) {
+    out.append((char const*) &val, sizeof(val));
+}
+
+/** Write an ELF64 file with just the given sections (by name, contents), and no segments. */
+void writeELF(std::string const& path, std::vector<std::pair<std::string, std::string>> sections) {
+    sections.push_back({".shstrtab", std::string(1, '\0')});
+    auto& names = sections.back().second;
+    std::vector<uint32_t> nameOffsets;
+    for (auto const& section : sections) {
+        nameOffsets.push_back(uint32_t(names.size()));
+        names += section.first + '\0';
+    }
+    std::string body;
+    std::string headers(64, '\0');  // section 0 is the null section
+    for (size_t i = 0; i < sections.size(); i++) {
+        put(headers, nameOffsets[i]);
+        put(headers, uint32_t(i + 1 < sections.size() ? 1 : 3));  // SHT_PROGBITS, SHT_STRTAB
+        put(headers, uint64_t(0));                                 // flags
+        put(headers, uint64_t(0));                                 // addr
+        put(headers, uint64_t(64 + body.size()));                  // offset
+        put(headers, uint64_t(sections[i].second.size()));
+        put(headers, uint64_t(0));  // link, info
+        put(headers, uint64_t(1));  // addralign
+        put(headers, uint64_t(0));  // entsize
+        body += sections[i].second;
+    }
+    body.resize((body.size() + 7) & ~size_t(7));
+    std::string elf("\x7f" "ELF\x02\x01\x01", 7);  // ELF64, little-endian, version 1
+    elf.resize(16, '\0');
+    put(elf, uint16_t(1));                  // ET_REL
+    put(elf, uint16_t(62));                 // x86-64
+    put(elf, uint32_t(1));                  // version
+    put(elf, uint64_t(0));                  // entry
+    put(elf, uint64_t(0));                  // phoff
+    put(elf, uint64_t(64 + body.size()));   // shoff
+    put(elf, uint32_t(0));                  // flags
+    put(elf, uint16_t(64));                 // ehsize
+    put(elf, uint16_t(56));                 // phentsize
+    put(elf, uint16_t(0));                  // phnum
+    put(elf, uint16_t(64));                 // shentsize
+    put(elf, uint16_t(sections.size() + 1));
+    put(elf, uint16_t(sections.size()));    // shstrndx: the last
+    std::ofstream(path, std::ios::binary) << elf << body << headers;
+}
+
+/** A DWARF 5 skeleton (`type` 4) or split (5) compile unit, with abbreviations at offset 0:
+ * one entry, of abbreviation `code`, with inline string attributes `strings`. */
+std::string dwarfUnit(uint8_t type, uint64_t dwoID, uint8_t code,
+                      std::vector<std::string> const& strings) {
+    std::string body;
+    put(body, uint16_t(5));  // version
+    put(body, type);
+    put(body, uint8_t(8));   // address size
+    put(body, uint32_t(0));  // abbreviations offset
+    put(body, dwoID);
+    put(body, code);
+    for (auto const& str : strings) { body += str + '\0'; }
+    std::string ret;
+    put(ret, uint32_t(body.size()));
+    return ret + body;
+}
+
+/** Abbreviation `code`: an entry with tag `tag`, no children, and `attrs` (as `DW_FORM_string`). */
+std::string dwarfAbbrev(uint8_t code, uint8_t tag, std::vector<uint8_t> const& attrs) {
+    std::string ret {char(code), char(tag), 0};
+    for (auto attr : attrs) { ret += {char(attr), 0x08}; }
+    return ret + std::string(3, '\0');  // end of attributes, then of abbreviations
+}
+
+/** A program whose debug info is one skeleton unit per `dwoIDs`, all naming `dwoName`. */
+void writeSkeletons(std::string const& path, std::vector<uint64_t> const& dwoIDs,
+                    std::string const& dwoName, std::string const& compDir) {
+    std::string info;
+    for (auto id : dwoIDs) { info += dwarfUnit(0x04, id, 1, {dwoName, compDir}); }
+    auto abbrev = dwarfAbbrev(1, cxx::DIE::SKELETON_UNIT, {cxx::DIE::DWO_NAME, cxx::DIE::COMP_DIR});
+    writeELF(path, {{".debug_info", info}, {".debug_abbrev", abbrev}});
+}
+
+/** Name of the split unit found for each skeleton in the binary at `path` ("" if none). */
+std::vector<std::string> splitUnitNames(std::string const& path) {
+    auto bin = cxx::Binary::open(path, 0);
+    assert(bin);
+    cxx::DWARF dwarf(*bin);
+    cxx::SplitDWARF split(bin.get(), dwarf);
+    std::vector<std::string> ret;
+    for (auto offset : dwarf.infoUnits()) {
+        cxx::DIEReader skeleton(dwarf, offset);
+        assert(skeleton.skeleton());
+        auto unit = split.find(skeleton);
+        if (!unit) {
+            ret.push_back("");
+            continue;
+        }
+        cxx::DIEReader reader(unit->dwarf, unit->offset, &skeleton);
+        assert(reader.compileUnit_ && reader.dwoID_ == skeleton.dwoID_);
+        ret.push_back(reader.string(*reader.top_.name));
+    }
+    return ret;
+}
+
+Test corruptELF([] {
+    namespace fs = std::filesystem;
+    auto dir = fs::temp_directory_path() / ("cxx-elf-" + std::to_string(getpid()));
+    fs::create_directories(dir);
+    auto path = (dir / "prog").string();
+    writeELF(path, {{".debug_info", std::string(16, '\1')}, {".gnu_debuglink", "x"}});
+    std::string good;
+    {
+        std::ifstream in(path, std::ios::binary);
+        good.assign(std::istreambuf_iterator<char>(in), {});
+    }
+    auto shoff = good.size() - 4 * 64;  // four section headers, at the end
+    auto withBytes = [&](size_t offset, auto val) {
+        auto bytes = good;
+        std::memcpy(bytes.data() + offset, &val, sizeof(val));
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+        return cxx::Binary::open(path, 0);
+    };
+    auto names = [](cxx::Binary const& bin) {
+        std::vector<std::string> ret;
+        for (auto const& section : bin.sections()) { ret.push_back(section->name()); }
+        return ret;
+    };
+
+    auto bin = withBytes(0, good[0]);  // unchanged
+    std::vector<std::string> const expected {".debug_info", ".gnu_debuglink", ".shstrtab"};
+    assert(names(*bin) == expected);
+    assert(bin->sections()[0]->contents().size_ == 16);
+
+    // Section headers out of the file, or of another size: no sections
+    assert(withBytes(40, uint64_t(good.size() - 64))->sections().empty());
+    assert(withBytes(40, uint64_t(1) << 62)->sections().empty());
+    assert(withBytes(58, uint16_t(32))->sections().empty());
+    assert(withBytes(60, uint16_t(200))->sections().empty());
+    // Contents out of the file, or wrapping around: empty
+    bin = withBytes(shoff + 64 + 24, uint64_t(good.size() - 8));
+    assert(bin->sections()[0]->contents().size_ == 0);
+    bin = withBytes(shoff + 64 + 32, uint64_t(-1));
+    assert(bin->sections()[0]->contents().size_ == 0);
+    // Names out of `.shstrtab`, or `.shstrtab` out of range: no names
+    bin = withBytes(shoff + 64, uint32_t(1) << 30);
+    assert(bin->sections()[0]->name().empty() && bin->sections()[0]->contents().size_ == 16);
+    bin = withBytes(62, uint16_t(99));
+    assert((names(*bin) == std::vector<std::string> {"", "", ""}));
+    assert(!bin->debugLink());
+
+    // Truncated anywhere: no crash, and nothing past the end is read
+    for (size_t size : {size_t(64), size_t(100), good.size() / 2, good.size() - 1}) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << good.substr(0, size);
+        auto bin = cxx::Binary::open(path, 0);
+        for (auto const& section : bin->sections()) {
+            section->name();
+            section->contents();
+        }
+        bin->buildID();
+        bin->debugLink();
+        bin->symbols();
+    }
+    fs::remove_all(dir);
+});
+
+Test debugFileByDebugLink([] {
+    namespace fs = std::filesystem;
+    auto dir = fs::temp_directory_path() / ("cxx-debuglink-" + std::to_string(getpid()));
+    fs::create_directories(dir / ".debug");
+    auto debug = (dir / ".debug" / "prog.debug").string();
+    writeELF(debug, {{".debug_info", std::string(16, '\0')}});
+    auto file = cxx::File::open(debug);
+    auto crc = cxx::detail::crc32(file->cur().base_, file->cur().size_);
+
+    auto linkTo = [&](std::string const& name, uint32_t crc) {
+        std::string link = "prog.debug";
+        link.resize(12, '\0');  // NUL-terminated, padded to 4 bytes
+        put(link, crc);
+        auto path = (dir / name).string();
+        writeELF(path, {{".gnu_debuglink", link}});
+        return cxx::Binary::open(path, 0);
+    };
+    auto& files = cxx::DebugFiles::get();
+    auto saved = files.dirs();
+    files.setDirs({});
+    auto good = linkTo("good", crc);
+    assert(good->debugLink() && good->debugLink()->file == "prog.debug");
+    auto found = files.find(*good);
+    assert(found.size() == 1 && found[0]->file_->path_ == debug);
+    assert(files.find(*linkTo("bad", crc ^ 1)).empty());  // not the file it was linked with
+    files.setDirs(saved);
+    fs::remove_all(dir);
+});
+
+Test debugFilesNotBinaries([] {
+    Dl_info info;
+    dladdr((void*) &recurse, &info);
+    auto bin = cxx::Binary::open(info.dli_fname, 0);
+    auto id = bin->buildID();
+    if (id.empty()) { return; }  // not linked with `--build-id`
+
+    // Not files to map at all: empty, too short, a directory
+    namespace fs = std::filesystem;
+    auto dir = fs::temp_directory_path() / ("cxx-notbin-" + std::to_string(getpid()));
+    fs::create_directories(dir / "subdir");
+    std::ofstream((dir / "empty").string());
+    std::ofstream((dir / "short").string()) << "\x7f" "ELF";
+    for (auto name : {"empty", "short", "subdir", "missing"}) {
+        assert(!cxx::Binary::open((dir / name).string(), 0));
+    }
+    assert(!cxx::File::open((dir / "empty").string()) && !cxx::File::open(dir.string()));
+
+    // By build ID: an empty placeholder, and a binary of another build, aren't taken
+    auto debug = dir / ".build-id" / id.substr(0, 2) / (id.substr(2) + ".debug");
+    fs::create_directories(debug.parent_path());
+    auto& files = cxx::DebugFiles::get();
+    auto saved = files.dirs();
+    files.setDirs({dir.string()});
+    std::ofstream(debug.string());
+    assert(files.find(*bin).empty());
+    writeELF(debug.string(), {{".debug_info", std::string(16, '\0')}});
+    files.setDirs({dir.string()});  // (forgets what was found for the build ID)
+    assert(files.find(*bin).empty());
+    files.setDirs(saved);
+    fs::remove_all(dir);
+});
+
+Test splitDWARFFromDWO([] {
+    namespace fs = std::filesystem;
+    auto dir = fs::temp_directory_path() / ("cxx-dwo-" + std::to_string(getpid()));
+    fs::create_directories(dir);
+    auto abbrev = dwarfAbbrev(1, cxx::DIE::COMPILE_UNIT, {cxx::DIE::NAME});
+    writeELF((dir / "a.dwo").string(), {{".debug_info.dwo", dwarfUnit(0x05, 0xa, 1, {"a.cc"})},
+                                        {".debug_abbrev.dwo", abbrev}});
+
+    // By its compilation dir; else beside the binary (built elsewhere, say); and by unit ID
+    auto prog = (dir / "prog").string();
+    writeSkeletons(prog, {0xa, 0xb}, "a.dwo", dir.string());
+    assert((splitUnitNames(prog) == std::vector<std::string> {"a.cc", ""}));
+    writeSkeletons(prog, {0xa}, "a.dwo", "/nonexistent");
+    assert((splitUnitNames(prog) == std::vector<std::string> {"a.cc"}));
+    fs::remove_all(dir);
+});
+
+Test splitDWARFFromDWP([] {
+    namespace fs = std::filesystem;
+    auto dir = fs::temp_directory_path() / ("cxx-dwp-" + std::to_string(getpid()));
+    fs::create_directories(dir);
+
+    // Units A, B, C (rows 1-3 of the index), with IDs which collide in the 4-slot hash table:
+    // A and B both start at slot 1; B then steps by ((id >> 32) & 3) | 1 = 3, to slot 0
+    constexpr static uint64_t kA = 0x100000001, kB = 0x200000001, kC = 0x2;
+    std::string infos[3], abbrevs[3];
+    char const* names[3] = {"a.cc", "b.cc", "c.cc"};
+    uint64_t ids[3] = {kA, kB, kC};
+    for (int i = 0; i < 3; i++) {
+        // Each with its own abbreviation codes, so a unit read with another's can't pass
+        infos[i] = dwarfUnit(0x05, ids[i], uint8_t(i + 1), {names[i]});
+        abbrevs[i] = dwarfAbbrev(uint8_t(i + 1), cxx::DIE::COMPILE_UNIT, {cxx::DIE::NAME});
+    }
+    // `.debug_info.dwo` in another order than the rows: C, A, B
+    auto info = infos[2] + infos[0] + infos[1];
+    uint32_t infoOffsets[3] = {uint32_t(infos[2].size()),
+                               uint32_t(infos[2].size() + infos[0].size()), 0};
+    auto abbrev = abbrevs[0] + abbrevs[1] + abbrevs[2];
+    uint32_t abbrevOffsets[3] = {0, uint32_t(abbrevs[0].size()),
+                                 uint32_t(abbrevs[0].size() + abbrevs[1].size())};
+
+    std::string index;
+    put(index, uint16_t(5));
+    put(index, uint16_t(0));
+    put(index, uint32_t(2));  // columns
+    put(index, uint32_t(3));  // units
+    put(index, uint32_t(4));  // slots
+    for (auto id : {kB, kA, kC, uint64_t(0)}) { put(index, id); }
+    for (auto row : {2, 1, 3, 0}) { put(index, uint32_t(row)); }
+    put(index, uint32_t(1));  // DW_SECT_INFO
+    put(index, uint32_t(3));  // DW_SECT_ABBREV
+    for (int i = 0; i < 3; i++) {
+        put(index, infoOffsets[i]);
+        put(index, abbrevOffsets[i]);
+    }
+    for (int i = 0; i < 3; i++) {
+        put(index, uint32_t(infos[i].size()));
+        put(index, uint32_t(abbrevs[i].size()));
+    }
+    auto prog = (dir / "prog").string();
+    writeELF(prog + ".dwp", {{".debug_info.dwo", info},
+                             {".debug_abbrev.dwo", abbrev},
+                             {".debug_cu_index", index}});
+
+    // Another ID in slot 1, which isn't there: probes slots 1, 2 and (empty) 3
+    writeSkeletons(prog, {kC, kA, 0x1, kB}, "missing.dwo", dir.string());
+    assert((splitUnitNames(prog) == std::vector<std::string> {"c.cc", "a.cc", "", "b.cc"}));
+    fs::remove_all(dir);
+});
+
+Test symbolIndexMatchesDebugInfo([] {
+    Dl_info info;
+    dladdr((void*) &recurse, &info);
+    auto bin = cxx::Binary::open(info.dli_fname, 0);
+    auto id = bin->buildID();
+    if (id.empty()) { return; }  // not linked with `--build-id`
+
+    namespace fs = std::filesystem;
+    auto dir = fs::temp_directory_path() / ("cxx-symidx-" + std::to_string(getpid()));
+    fs::create_directories(dir);
+    auto& cache = cxx::SymbolIndexCache::get();
+    cache.setDir(dir.string());
+    auto index = cache.open(*bin);
+    cache.setDir("");
+    assert(index);
+    auto path = (dir / (id + ".symidx")).string();
+    assert(fs::exists(path));
+
+    // Same answers as the tables it was made from
+    size_t rows = 0;
+    bin->lines().forEachRow([&](cxx::LineTable::Row const& row, std::string const&) {
+        if (rows++ % 7) { return; }
+        auto hit = bin->lines().find(row.addr);
+        auto loc = index->line(row.addr);
+        assert(bool(hit) == bool(loc));
+        if (!loc) { return; }
+        assert(loc->file == hit.table->file(*hit.row));
+        assert(loc->line == hit.row->line && loc->col == hit.row->col);
+    });
+    assert(rows > 0);
+    for (auto const& sym : bin->symbols().symbols()) {
+        assert(std::string(index->symbol(sym.addr)) == bin->symbols().find(sym.addr)->name);
+    }
+    bin->rebase(uintptr_t(info.dli_fbase));
+    auto addr = uintptr_t(&recurse) - bin->vmaSlide_;
+    auto expected = bin->functions().find(addr);
+    auto scopes = index->functions(addr);
+    assert(!scopes.empty() && scopes.size() == expected.size());
+    assert(std::string(scopes.back().name) == expected.back().name);
+
+    // Mapped again, but only for the right build, and only if it's intact
+    assert(cxx::SymbolIndex::load(path, id));
+    assert(!cxx::SymbolIndex::load(path, id + "00"));
+    fs::resize_file(path, fs::file_size(path) - 1);
+    assert(!cxx::SymbolIndex::load(path, id));
+    fs::remove_all(dir);
+});
+
+namespace {
+std::vector<uint8_t> unhex(std::string_view hex) {
+    std::vector<uint8_t> ret;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        ret.push_back(uint8_t(std::stoi(std::string(hex.substr(i, 2)), nullptr, 16)));
+    }
+    return ret;
+}
+
+std::string inflated(std::vector<uint8_t> const& zlib, size_t size) {
+    std::string ret(size, '\0');
+    cxx::inflateZlib(zlib.data(), zlib.size(), (uint8_t*) ret.data(), size);
+    return ret;
+}
+}  // namespace
+
+Test inflateBlockTypes([] {
+    // From Python's `zlib`: stored (level 0), fixed codes (Z_FIXED), dynamic codes (level 9)
+    assert(inflated(unhex("7801010c00f3ff73746f7265642062797465731fcf04d9"), 12) == "stored bytes");
+    assert(inflated(unhex("78014b4c4a4e84211d858cd49c9c7c08090076e7092d"), 25)
+           == "abcabcabcabc, hello hello");
+    std::string squares;
+    for (int i = 0; i < 40; i++) {
+        squares += std::to_string(i) + " squared is " + std::to_string(i * i) + "\n";
+    }
+    auto dynamic = unhex(
+            "78da5dd13b0e02310c04d07e4eb147883ff1c6c74182821210f767b6cb503ab2ec97f1383eafefedfd"
+            "b81fcfcf31607b69f0bd4cc45e36529a0b73af7da2f63a0aa74c6bacbdae44eff532d89005833cf539"
+            "7b846899b05056c314da05532aad568a678f707d718e80c3b9abf58b4c4ccc49b38b39933d1aeb4ab8"
+            "98a7375cccf32cb8988b6617735d3d623eaf39623eaf5d1a333d21e6a639c4dcfc5768ce839f0f0d7a"
+            "30a1d0a48d31c6d493d11da54f3c4808dc82578bf577596e14ba4ddeff07fbedce6d");
+    assert(inflated(dynamic, squares.size()) == squares);
+
+    // Bad data, or the wrong size, throw
+    auto throws = [](std::vector<uint8_t> const& zlib, size_t size) {
+        try {
+            inflated(zlib, size);
+        } catch (std::runtime_error const&) { return true; }
+        return false;
+    };
+    assert(throws(dynamic, squares.size() - 1));
+    assert(throws(dynamic, squares.size() + 1));
+    auto badChecksum = dynamic;
+    badChecksum.back() ^= 1;
+    assert(throws(badChecksum, squares.size()));
+    auto truncated = dynamic;
+    truncated.resize(truncated.size() / 2);
+    assert(throws(truncated, squares.size()));
+});
+
+[[gnu::noinline]] void crashHere() {
+    int volatile* volatile ptr = nullptr;
+    *ptr = 1;  // (a volatile store, else an optimizer may drop it)
+}
+
+Test crashHandlerTrace([] {
+    int fds[2];
+    assert(pipe(fds) == 0);
+    auto pid = fork();
+    if (!pid) {
+        rlimit noCore {0, 0};
+        setrlimit(RLIMIT_CORE, &noCore);
+        close(fds[0]);
+        cxx::CrashHandler::get().install(fds[1]);
+        crashHere();
+        _exit(0);
+    }
+    close(fds[1]);
+    std::string text;
+    char buf[4096];
+    for (ssize_t n; (n = read(fds[0], buf, sizeof(buf))) > 0;) { text.append(buf, n); }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    assert(!WIFEXITED(status) || WEXITSTATUS(status));  // (a sanitizer's handler may exit)
+    assert(text.starts_with("*** crash: signal 11 (SIGSEGV), address 0x0000000000000000\n"));
+    assert(text.ends_with("*** end\n"));
+
+    // Symbolized here, after the fact; the child was a fork, so had the same modules
+    std::istringstream in(text);
+    auto frames = cxx::CrashHandler::read(in);
+    assert(frames.size() > 1);
+    assert(frames[0]->filename == cxx::ModuleMap::get().find(uintptr_t(&crashHere))->path);
+    cxx::StackResolver sr;
+    frames[0]->resolve(sr);
+    assert(frames[0]->sym().starts_with("crashHere"));
+    assert(frames[0]->loc.line);
+});
+
+Test crashTraceFromElsewhere([] {
+    auto const* mod = cxx::ModuleMap::get().find(uintptr_t(&crashHere));
+    if (!mod) { return; }  // no `dl_iterate_phdr` here
+
+    // As written by a process with this program loaded elsewhere (after resolving here, so the
+    // binary's already cached, with this process's base)
+    cxx::StackResolver sr;
+    cxx::StackFrame here;
+    here.address = (void const*) (uintptr_t(&crashHere) + 1);
+    here.resolve(sr);
+    constexpr static uintptr_t kShift = 0x10000000;
+    std::ostringstream text;
+    text << std::hex << "*** crash: signal 11 (SIGSEGV), address 0x0\n"
+         << "frame 0x" << uintptr_t(here.address) + kShift << "\n"
+         << "module 0x" << mod->begin + kShift << " 0x" << mod->end + kShift << " " << mod->path
+         << "\n*** end\n";
+
+    std::istringstream in(text.str());
+    auto frames = cxx::CrashHandler::read(in);
+    assert(frames.size() == 1);
+    assert(frames[0]->loadBase == mod->begin + kShift);
+    frames[0]->resolve(sr);
+    assert(frames[0]->sym() == here.sym() && frames[0]->sym().starts_with("crashHere"));
+    assert(frames[0]->loc.line && frames[0]->loc.line == here.loc.line);
+});